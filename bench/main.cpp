@@ -0,0 +1,574 @@
+#include "progress_spinner/progress_indicators.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Benchmarks for the progress indicator library.
+//
+// All output of the indicators goes to a sink that only counts, so terminal
+// speed does not skew the results. Every result is printed to stdout as one
+// JSON object per line. Pass --quick for a shorter run with fewer samples.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * \brief Sink that discards frames and counts them.
+ *
+ * Reports itself as a terminal so indicators draw in place, as they would
+ * on a real terminal.
+ */
+class NullSink : public OutputSink {
+public:
+    NullSink() : frames(0), bytes(0), last_write_ns(0), write_delay_us(0) {}
+
+    bool write(const char* data, size_t size) override {
+        (void)data;
+        int64_t delay_us = write_delay_us.load(std::memory_order_relaxed);
+        if (delay_us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+        }
+        bytes.fetch_add(size, std::memory_order_relaxed);
+        last_write_ns.store(nowNs(), std::memory_order_relaxed);
+        frames.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    bool isTerminal() const override {
+        return true;
+    }
+
+    void reset() {
+        frames.store(0);
+        bytes.store(0);
+    }
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    std::atomic<uint64_t> frames;
+    std::atomic<uint64_t> bytes;
+    std::atomic<int64_t> last_write_ns;
+    // Simulates a slow link, e.g. a congested SSH session
+    std::atomic<int64_t> write_delay_us;
+};
+
+std::shared_ptr<NullSink> sink;
+double scale = 1.0;
+
+size_t scaled(size_t count) {
+    return std::max<size_t>(1, static_cast<size_t>(count * scale));
+}
+
+double seconds(Clock::duration duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+/**
+ * \brief Prints one result line.
+ *
+ * \param bench Name of the benchmark.
+ * \param params JSON members describing the configuration, may be empty.
+ * \param results JSON members with the measured values.
+ */
+void report(const char* bench, const std::string& params, const std::string& results) {
+    std::printf("{\"bench\":\"%s\"%s%s,%s}\n", bench,
+                params.empty() ? "" : ",", params.c_str(), results.c_str());
+    std::fflush(stdout);
+}
+
+std::string field(const char* name, double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "\"%s\":%.1f", name, value);
+    return buffer;
+}
+
+std::string field(const char* name, uint64_t value) {
+    return "\"" + std::string(name) + "\":" + std::to_string(value);
+}
+
+std::string field(const char* name, const char* value) {
+    return "\"" + std::string(name) + "\":\"" + value + "\"";
+}
+
+HProgressBarOptions barOptions(int refresh_rate_hz) {
+    return HProgressBarOptions(
+        option::Label{"Bench: "},
+        option::CompletedLabel{"done"},
+        option::NumOfSegments{40},
+        option::ProgressChars{"░", "█"},
+        option::BracketChars{"[", "]"},
+        option::RefreshRateHz{refresh_rate_hz},
+        option::PartialChars{"▏", "▎", "▍", "▌", "▋", "▊", "▉"}
+    );
+}
+
+/**
+ * \brief Calls function count times and returns the mean ns per call.
+ */
+template <typename Function>
+double nsPerCall(size_t count, Function function) {
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        function(i);
+    }
+    return seconds(Clock::now() - start) * 1e9 / static_cast<double>(count);
+}
+
+/**
+ * \brief Cost of updateProgress, updateText, advance and track() on a single
+ * thread.
+ */
+void benchSingleThreaded() {
+    const char* modes[] = {"immediate", "deferred"};
+    for (int rate : {0, 30}) {
+        const char* mode = modes[rate > 0 ? 1 : 0];
+        size_t count = scaled(rate > 0 ? 10000000 : 200000);
+        HProgressBar bar(barOptions(rate));
+        bar.start();
+
+        double ns = nsPerCall(count, [&](size_t i) {
+            bar.updateProgress(100.0 * static_cast<double>(i) / static_cast<double>(count));
+        });
+        report("update_progress", field("mode", mode) + "," + field("threads", uint64_t(1)),
+               field("ns_per_call", ns) + "," + field("calls", uint64_t(count)));
+
+        bar.setTotal(count);
+        ns = nsPerCall(count, [&](size_t) { bar.advance(); });
+        report("advance", field("mode", mode) + "," + field("threads", uint64_t(1)),
+               field("ns_per_call", ns) + "," + field("calls", uint64_t(count)));
+        bar.setTotal(0);
+
+        std::vector<uint32_t> items(count, 1);
+        uint64_t sum = 0;
+        Clock::time_point start = Clock::now();
+        for (uint32_t item : track(items, bar)) {
+            sum += item;
+        }
+        ns = seconds(Clock::now() - start) * 1e9 / static_cast<double>(count);
+        report("track", field("mode", mode) + "," + field("threads", uint64_t(1)),
+               field("ns_per_item", ns) + "," + field("items", sum));
+        bar.setTotal(0);
+
+        SharedProgress shared(1);
+        SharedProgress::Slot& slot = shared.slot(0);
+        bar.setSource(shared.source(0));
+        ns = nsPerCall(count, [&](size_t) { slot.advance(); });
+        report("shared_slot_advance", field("mode", mode) + "," + field("threads", uint64_t(1)),
+               field("ns_per_call", ns) + "," + field("calls", uint64_t(count)));
+        bar.setSource(nullptr);
+
+        size_t text_count = scaled(200000);
+        const std::string labels[] = {"Bench: ", "Bench 2: "};
+        ns = nsPerCall(text_count, [&](size_t i) { bar.updateText(labels[i & 1]); });
+        report("update_text", field("mode", mode) + "," + field("threads", uint64_t(1)),
+               field("ns_per_call", ns) + "," + field("calls", uint64_t(text_count)));
+
+        bar.stop();
+    }
+}
+
+/**
+ * \brief Cost per call when 1 to 64 threads update the same deferred bar,
+ * directly or through a ShardedCounter shown with setSource().
+ */
+void benchContended() {
+    for (size_t threads : {1, 2, 4, 8, 16, 32, 64}) {
+        size_t per_thread = scaled(400000);
+        for (const char* call : {"update_progress", "advance", "sharded_advance"}) {
+            bool advance = std::string(call) == "advance";
+            bool sharded = std::string(call) == "sharded_advance";
+            HProgressBar bar(barOptions(30));
+            auto counter = std::make_shared<ShardedCounter>(threads);
+            bar.start();
+            bar.setTotal(advance ? threads * per_thread : 0);
+            if (sharded) {
+                counter->setTotal(threads * per_thread);
+                bar.setSource(counter);
+            }
+
+            std::atomic<bool> go(false);
+            std::vector<std::thread> workers;
+            for (size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t]() {
+                    ShardedCounter::Shard& shard = counter->shard(t);
+                    while (!go.load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    for (size_t i = 0; i < per_thread; ++i) {
+                        if (sharded) {
+                            shard.advance();
+                        } else if (advance) {
+                            bar.advance();
+                        } else {
+                            bar.updateProgress(100.0 * static_cast<double>(i) / static_cast<double>(per_thread));
+                        }
+                    }
+                });
+            }
+            Clock::time_point start = Clock::now();
+            go.store(true, std::memory_order_release);
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+            double elapsed = seconds(Clock::now() - start);
+            bar.stop();
+
+            double calls = static_cast<double>(threads * per_thread);
+            report(call, field("mode", "deferred") + "," + field("threads", uint64_t(threads)),
+                   field("ns_per_call", elapsed * 1e9 * static_cast<double>(threads) / calls) + "," +
+                   field("mcalls_per_s", calls / elapsed / 1e6));
+        }
+    }
+}
+
+/**
+ * \brief Calls produce until the duration has passed and reports the frames
+ *        per second and bytes per frame that reached the sink meanwhile.
+ */
+template <typename Produce>
+void measureFrames(const char* indicator, int rate_hz, Produce produce) {
+    Clock::duration duration = std::chrono::milliseconds(static_cast<int>(1000 * scale) + 1);
+    sink->reset();
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; Clock::now() - start < duration; ++i) {
+        produce(i);
+    }
+    double elapsed = seconds(Clock::now() - start);
+    uint64_t frames = sink->frames.load();
+    uint64_t bytes = sink->bytes.load();
+    report("frames", field("indicator", indicator) + "," + field("rate_hz", uint64_t(rate_hz)),
+           field("fps", frames / elapsed) + "," +
+           field("bytes_per_frame", frames > 0 ? static_cast<double>(bytes) / frames : 0.0) + "," +
+           field("frames", frames));
+}
+
+/**
+ * \brief Frames per second and bytes per frame of every indicator type under
+ *        continuous updates.
+ */
+void benchFrames() {
+    const int rate = 60;
+    {
+        HProgressBar bar(barOptions(rate));
+        bar.start();
+        measureFrames("h_progress_bar", rate, [&](size_t i) {
+            bar.updateProgress(static_cast<double>(i % 1000000) / 10000.0);
+        });
+        bar.stop();
+    }
+    {
+        HProgressBar bar(barOptions(rate));
+        bar.setTotal(50000000);
+        bar.start();
+        measureFrames("h_progress_bar_work", rate, [&](size_t) { bar.advance(); });
+        bar.stop();
+    }
+    {
+        VProgressBar bar(VProgressBarOptions(
+            option::Label{"Bench: "},
+            option::CompletedLabel{"done"},
+            option::CharFrames{" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"},
+            option::RefreshRateHz{rate}
+        ));
+        measureFrames("v_progress_bar", rate, [&](size_t i) {
+            bar.updateProgress(static_cast<double>(i % 1000000) / 10000.1);
+        });
+        bar.stop();
+    }
+    {
+        ProgressSpinner spinner(ProgressSpinnerOptions(
+            option::Label{"Bench: "},
+            option::CompletedLabel{"done"},
+            option::CharFrames{"⠋", "⠙", "⠹", "⠸", "⠼", "⠴", "⠦", "⠧", "⠇", "⠏"},
+            option::UpdateIntervalMs{1000 / rate}
+        ));
+        spinner.start();
+        measureFrames("progress_spinner", rate, [](size_t) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); });
+        spinner.stop();
+    }
+    {
+        MultiProgress multi(MultiProgressOptions(option::RefreshRateHz{rate}));
+        HProgressBar& first = multi.add<HProgressBar>(barOptions(0));
+        HProgressBar& second = multi.add<HProgressBar>(barOptions(0));
+        ProgressSpinner& spinner = multi.add<ProgressSpinner>(ProgressSpinnerOptions());
+        multi.start();
+        first.start();
+        second.start();
+        spinner.start();
+        measureFrames("multi_progress_3_rows", rate, [&](size_t i) {
+            first.updateProgress(static_cast<double>(i % 1000000) / 10000.0);
+            second.updateProgress(static_cast<double>(i % 3000000) / 30000.0);
+        });
+        first.stop();
+        second.stop();
+        spinner.stop();
+        multi.stop();
+    }
+}
+
+/**
+ * \brief Cost of a leaf update and of aggregating a three-level task tree.
+ */
+void benchTaskTree() {
+    for (size_t leaves : {100, 1000, 10000}) {
+        TaskNode job;
+        std::vector<TaskNode*> files;
+        for (size_t phase = 0; phase < 10; ++phase) {
+            TaskNode& node = job.addChild(static_cast<double>(phase + 1));
+            for (size_t i = 0; i < leaves / 10; ++i) {
+                files.push_back(&node.addChild(1.0, 1000));
+            }
+        }
+
+        size_t count = scaled(10000000);
+        double update_ns = nsPerCall(count, [&](size_t i) { files[i % files.size()]->advance(); });
+
+        size_t aggregates = scaled(2000);
+        double sum = 0.0;
+        double aggregate_ns = nsPerCall(aggregates, [&](size_t) { sum += job.fraction(); });
+        report("task_tree", field("leaves", uint64_t(files.size())),
+               field("ns_per_update", update_ns) + "," +
+               field("us_per_aggregate", aggregate_ns / 1000.0) + "," +
+               field("fraction", sum / static_cast<double>(aggregates)));
+    }
+}
+
+/**
+ * \brief Task table updates and the CPU time of its frames as the number of
+ *        tasks grows.
+ */
+void benchTaskTable() {
+    const int rate_hz = 100;
+    for (size_t tasks : {1000, 10000, 100000}) {
+        TaskTable table(tasks, TaskTableOptions(option::TopTasks{5}, option::TaskOrder(), option::RefreshRateHz{rate_hz}));
+        for (size_t i = 0; i < tasks; ++i) {
+            table.addTask("file " + std::to_string(i % 1000), 1000000);
+        }
+        // A thousand transfers in flight, spread over the table
+        std::vector<TaskTable::TaskId> active;
+        for (size_t i = 0; i < tasks; i += tasks / 1000) {
+            table.startTask(static_cast<TaskTable::TaskId>(i));
+            active.push_back(static_cast<TaskTable::TaskId>(i));
+        }
+
+        size_t count = scaled(10000000);
+        double update_ns = nsPerCall(count, [&](size_t i) { table.advance(active[i % active.size()]); });
+
+        table.start();
+        std::clock_t cpu_start = std::clock();
+        Clock::time_point start = Clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(1000 * scale) + 1));
+        double elapsed = seconds(Clock::now() - start);
+        double cpu_us = 1e6 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        table.stop();
+
+        report("task_table", field("tasks", uint64_t(tasks)) + "," + field("running", uint64_t(active.size())),
+               field("ns_per_update", update_ns) + "," +
+               field("us_per_frame", cpu_us / (elapsed * rate_hz)));
+    }
+}
+
+/**
+ * \brief CPU time spent on spinner wakeups while the program is otherwise
+ *        idle.
+ */
+void benchSpinnerWakeups() {
+    for (const char* state : {"running", "paused", "hidden"}) {
+        for (size_t count : {1, 16, 256}) {
+            std::vector<std::unique_ptr<ProgressSpinner>> spinners;
+            for (size_t i = 0; i < count; ++i) {
+                spinners.emplace_back(new ProgressSpinner(ProgressSpinnerOptions(
+                    option::Label{"Spin: "},
+                    option::CompletedLabel{"done"},
+                    option::CharFrames{"|", "/", "-", "\\"},
+                    option::UpdateIntervalMs{100}
+                )));
+                spinners.back()->start();
+                if (std::string(state) == "paused") {
+                    spinners.back()->pause();
+                } else if (std::string(state) == "hidden") {
+                    spinners.back()->setHidden(true);
+                }
+            }
+
+            sink->reset();
+            std::clock_t cpu_start = std::clock();
+            Clock::time_point start = Clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(1000 * scale) + 1));
+            double elapsed = seconds(Clock::now() - start);
+            double cpu_us = 1e6 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+            uint64_t writes = sink->frames.load();
+
+            for (auto& spinner : spinners) {
+                spinner->stop();
+            }
+            report("spinner_wakeups", field("spinners", uint64_t(count)) + "," + field("interval_ms", uint64_t(100)) + "," +
+                                          field("state", state),
+                   field("cpu_us_per_s", cpu_us / elapsed) + "," +
+                   field("writes_per_s", writes / elapsed) + "," +
+                   field("cpu_us_per_write", writes > 0 ? cpu_us / writes : 0.0));
+        }
+    }
+}
+
+/**
+ * \brief Time stop() takes to return, measured at a random point of the
+ * frame interval.
+ *
+ * stop() must not wait for the next tick, so this stays far below the
+ * interval however long it is.
+ */
+void benchStopLatency() {
+    for (int interval_ms : {100, 1000}) {
+        size_t samples = scaled(20);
+        std::vector<double> latencies;
+        latencies.reserve(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            ProgressSpinner spinner(ProgressSpinnerOptions(
+                option::Label{"Spin: "},
+                option::CompletedLabel{"done"},
+                option::CharFrames{"|", "/", "-", "\\"},
+                option::UpdateIntervalMs{interval_ms}
+            ));
+            spinner.start();
+            std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(i * 37 % 50)));
+            Clock::time_point start = Clock::now();
+            spinner.stop();
+            latencies.push_back(seconds(Clock::now() - start) * 1e6);
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        report("spinner_stop", field("interval_ms", uint64_t(interval_ms)),
+               field("p50_us", latencies[latencies.size() / 2]) + "," +
+               field("max_us", latencies.back()));
+    }
+}
+
+/**
+ * \brief Frame rate while every write blocks for 5 ms, as on a congested
+ * link, and after writes are fast again.
+ *
+ * Once writes are fast, the pacer halves the slowdown with every frame, so
+ * the rate only recovers over a few stretched intervals. The recovery phase
+ * runs until the slowdown is back at 1, reports how long that took, and
+ * then measures the rate over the usual window.
+ */
+void benchBackpressure() {
+    const int rate = 60;
+    // Far beyond the log2(max_slowdown) halvings recovery takes at 2 Hz
+    const std::chrono::seconds recovery_limit(10);
+    ProgressSpinner spinner(ProgressSpinnerOptions(
+        option::Label{"Bench: "},
+        option::CompletedLabel{"done"},
+        option::CharFrames{"|", "/", "-", "\\"},
+        option::UpdateIntervalMs{1000 / rate}
+    ));
+    HProgressBar bar(barOptions(0));
+    FramePacer& pacer = RenderScheduler::instance().pacer();
+    size_t step = 0;
+    auto update = [&] {
+        bar.updateProgress(static_cast<double>(step++ % 100000) / 1000.0);
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    };
+    bar.start();
+    spinner.start();
+    for (int64_t delay_us : {5000, 0}) {
+        sink->write_delay_us.store(delay_us);
+        std::string recovery;
+        if (delay_us == 0) {
+            Clock::time_point start = Clock::now();
+            while (pacer.slowdown() > 1.0 && Clock::now() < start + recovery_limit) {
+                update();
+            }
+            recovery = "," + field("recovery_ms", seconds(Clock::now() - start) * 1e3);
+        }
+        sink->reset();
+        Clock::time_point start = Clock::now();
+        Clock::time_point end = start + std::chrono::milliseconds(static_cast<int>(1000 * scale) + 1);
+        while (Clock::now() < end) {
+            update();
+        }
+        double elapsed = seconds(Clock::now() - start);
+        report("backpressure", field("write_delay_us", uint64_t(delay_us)) + "," + field("spinner_rate_hz", uint64_t(rate)),
+               field("writes_per_s", sink->frames.load() / elapsed) + "," +
+               field("spinner_effective_hz", spinner.frameRateHz()) + "," +
+               field("slowdown", pacer.slowdown()) + recovery);
+    }
+    spinner.stop();
+    bar.stop();
+}
+
+/**
+ * \brief Time from an update until its frame reaches the sink.
+ *
+ * In deferred mode, updates are spread over the frame interval, so the
+ * result shows the latency of an update arriving at a random time.
+ */
+void benchRenderLatency() {
+    for (int rate : {0, 30, 60}) {
+        HProgressBar bar(barOptions(rate));
+        bar.start();
+        size_t samples = scaled(rate > 0 ? 40 : 10000);
+        std::vector<double> latencies;
+        latencies.reserve(samples);
+        for (size_t i = 0; i < samples; ++i) {
+            if (rate > 0) {
+                int64_t interval_us = 1000000 / rate;
+                int64_t phase_us = static_cast<int64_t>(i * 7919 % samples) * interval_us / static_cast<int64_t>(samples);
+                std::this_thread::sleep_for(std::chrono::microseconds(phase_us));
+            }
+            uint64_t frames = sink->frames.load(std::memory_order_acquire);
+            int64_t start = NullSink::nowNs();
+            bar.updateProgress(i % 2 == 0 ? 100.0 : 0.0);
+            while (sink->frames.load(std::memory_order_acquire) == frames) {
+                std::this_thread::yield();
+            }
+            latencies.push_back(static_cast<double>(sink->last_write_ns.load() - start) / 1000.0);
+        }
+        bar.stop();
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&](double p) {
+            return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+        };
+        report("render_latency", field("mode", rate > 0 ? "deferred" : "immediate") + "," + field("rate_hz", uint64_t(rate)),
+               field("p50_us", percentile(0.5)) + "," + field("p99_us", percentile(0.99)) + "," +
+               field("max_us", latencies.back()));
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--quick") {
+            scale = 0.1;
+        }
+    }
+
+    sink = std::make_shared<NullSink>();
+    IConsole::setSink(sink);
+
+    benchSingleThreaded();
+    benchContended();
+    benchFrames();
+    benchTaskTree();
+    benchTaskTable();
+    benchSpinnerWakeups();
+    benchStopLatency();
+    benchRenderLatency();
+    // Last, since it leaves the shared pacer slowed down for a while
+    benchBackpressure();
+
+    IConsole::setSink(nullptr);
+    return 0;
+}
@@ -0,0 +1,192 @@
+#ifndef PROGRESS_INDICATOR_BASIC_H_PROGRESS_BAR_HPP
+#define PROGRESS_INDICATOR_BASIC_H_PROGRESS_BAR_HPP
+
+#include "options.hpp"
+#include "segment_bar.hpp"
+#include "text_width.hpp"
+#include <array>
+#include <cstddef>
+
+/**
+ * \brief Glyph sets for BasicHProgressBar.
+ *
+ * A style is any type with static constexpr members empty, filled,
+ * open_bracket and close_bracket (const char*) and partial (std::array of
+ * const char*, from least to most filled; may be empty).
+ */
+namespace bar_style {
+
+struct Blocks {
+    static constexpr const char* empty = "░";
+    static constexpr const char* filled = "█";
+    static constexpr const char* open_bracket = "";
+    static constexpr const char* close_bracket = "";
+    static constexpr std::array<const char*, 0> partial = {};
+};
+
+struct SmoothBlocks {
+    static constexpr const char* empty = " ";
+    static constexpr const char* filled = "█";
+    static constexpr const char* open_bracket = "▕";
+    static constexpr const char* close_bracket = "▏";
+    static constexpr std::array<const char*, 7> partial = {"▏", "▎", "▍", "▌", "▋", "▊", "▉"};
+};
+
+struct Ascii {
+    static constexpr const char* empty = "-";
+    static constexpr const char* filled = "#";
+    static constexpr const char* open_bracket = "[";
+    static constexpr const char* close_bracket = "]";
+    static constexpr std::array<const char*, 0> partial = {};
+};
+
+} // namespace bar_style
+
+namespace basic_bar_detail {
+
+/**
+ * \brief Concatenates count copies of glyph at compile time.
+ */
+template <size_t Size>
+constexpr std::array<char, Size> repeatGlyph(const char* glyph, size_t count) {
+    std::array<char, Size> run{};
+    size_t glyph_size = staticLength(glyph);
+    size_t pos = 0;
+    for (size_t i = 0; i < count; ++i) {
+        for (size_t j = 0; j < glyph_size; ++j) {
+            run[pos++] = glyph[j];
+        }
+    }
+    return run;
+}
+
+template <size_t N>
+constexpr bool glyphsHaveWidth(const std::array<const char*, N>& glyphs, size_t width) {
+    for (size_t i = 0; i < N; ++i) {
+        if (!staticIsValidUtf8(glyphs[i]) || staticDisplayWidth(glyphs[i]) != width) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+constexpr std::array<size_t, N> glyphSizes(const std::array<const char*, N>& glyphs) {
+    std::array<size_t, N> sizes{};
+    for (size_t i = 0; i < N; ++i) {
+        sizes[i] = staticLength(glyphs[i]);
+    }
+    return sizes;
+}
+
+} // namespace basic_bar_detail
+
+/**
+ * \brief Horizontal progress bar whose width and glyphs are fixed at compile
+ * time.
+ *
+ * Behaves like HProgressBar, but the glyph runs are built by the compiler
+ * and malformed styles are rejected when the bar is instantiated instead of
+ * when it is constructed. Use HProgressBar when the look is only known at
+ * runtime.
+ */
+template <int Width, typename Style = bar_style::Blocks>
+class BasicHProgressBar : public SegmentBar {
+    static_assert(Width > 0, "BasicHProgressBar: Width must be greater than 0");
+    static_assert(staticIsValidUtf8(Style::empty) && staticIsValidUtf8(Style::filled),
+                  "BasicHProgressBar: empty and filled glyphs must be valid UTF-8");
+    static_assert(staticIsValidUtf8(Style::open_bracket) && staticIsValidUtf8(Style::close_bracket),
+                  "BasicHProgressBar: bracket glyphs must be valid UTF-8");
+    static_assert(staticDisplayWidth(Style::filled) > 0 &&
+                      staticDisplayWidth(Style::empty) == staticDisplayWidth(Style::filled),
+                  "BasicHProgressBar: empty and filled glyphs must have the same, non-zero display width");
+    static_assert(basic_bar_detail::glyphsHaveWidth(Style::partial, staticDisplayWidth(Style::filled)),
+                  "BasicHProgressBar: partial glyphs must be valid UTF-8 with the width of the filled glyph");
+
+public:
+    explicit BasicHProgressBar(const BasicHProgressBarOptions& options = BasicHProgressBarOptions());
+    ~BasicHProgressBar();
+
+private:
+    static constexpr int steps_per_segment = static_cast<int>(Style::partial.size()) + 1;
+    static constexpr size_t filled_size = staticLength(Style::filled);
+    static constexpr size_t empty_size = staticLength(Style::empty);
+    static constexpr size_t open_size = staticLength(Style::open_bracket);
+    static constexpr size_t close_size = staticLength(Style::close_bracket);
+    static constexpr size_t bar_width = Width * staticDisplayWidth(Style::filled) +
+                                        staticDisplayWidth(Style::open_bracket) +
+                                        staticDisplayWidth(Style::close_bracket);
+    static constexpr std::array<char, Width * filled_size> filled_run =
+        basic_bar_detail::repeatGlyph<Width * filled_size>(Style::filled, Width);
+    static constexpr std::array<char, Width * empty_size> empty_run =
+        basic_bar_detail::repeatGlyph<Width * empty_size>(Style::empty, Width);
+    static constexpr std::array<size_t, Style::partial.size()> partial_sizes =
+        basic_bar_detail::glyphSizes(Style::partial);
+
+    void composeLine(std::string& line) override;
+};
+
+/**
+ * \brief Constructor for BasicHProgressBar.
+ *
+ * \param options Labels and timing; the look is given by the template
+ *                parameters.
+ */
+template <int Width, typename Style>
+BasicHProgressBar<Width, Style>::BasicHProgressBar(const BasicHProgressBarOptions& options)
+    : SegmentBar(options.progress_label, options.completed_label, options.refresh_rate_hz, Width * steps_per_segment) {
+    log_line = LogLine(options.log_interval_sec, options.log_percent_step);
+    showCursor(false);
+}
+
+/**
+ * \brief Destructor for BasicHProgressBar; see ~HProgressBar().
+ */
+template <int Width, typename Style>
+BasicHProgressBar<Width, Style>::~BasicHProgressBar() {
+    unregisterIndicator();
+    stopRenderer();
+}
+
+/**
+ * \brief Appends the visible content of the bar to line.
+ *
+ * Every glyph size is a compile-time constant, so this is a handful of
+ * appends from the pre-rendered runs. The width is fixed, so on a narrow
+ * terminal only the label is shortened.
+ *
+ * \note The caller must hold the mutex.
+ */
+template <int Width, typename Style>
+void BasicHProgressBar<Width, Style>::composeLine(std::string& line) {
+    size_t columns = console.columns();
+    if (finished) {
+        line += fittedLabel(columns, completedWidth());
+        line += completed_label;
+        return;
+    }
+
+    composeStats();
+    bool show_stats = fitsLine(columns, bar_width + stats_reserve);
+    line += fittedLabel(columns, bar_width + (show_stats ? stats_reserve : 0));
+
+    line.append(Style::open_bracket, open_size);
+
+    int full_segments = current_units / steps_per_segment;
+    int partial_step = current_units % steps_per_segment;
+    int empty_segments = Width - full_segments;
+    line.append(filled_run.data(), static_cast<size_t>(full_segments) * filled_size);
+    if (partial_step > 0) {
+        size_t index = static_cast<size_t>(partial_step - 1);
+        line.append(Style::partial[index], partial_sizes[index]);
+        --empty_segments;
+    }
+    line.append(empty_run.data(), static_cast<size_t>(empty_segments) * empty_size);
+
+    line.append(Style::close_bracket, close_size);
+    if (show_stats) {
+        line += stats_text;
+    }
+}
+
+#endif // PROGRESS_INDICATOR_BASIC_H_PROGRESS_BAR_HPP
@@ -0,0 +1,54 @@
+#ifndef PROGRESS_INDICATOR_FRAME_PACER_HPP
+#define PROGRESS_INDICATOR_FRAME_PACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Slows every indicator down while the output is backed up.
+ *
+ * Each frame write reports how long it took and how many bytes the sink
+ * still had queued afterwards. A slow write or a backlog doubles the
+ * slowdown; every fast write with an empty queue halves it again, so the
+ * frame rate follows what the link can carry, e.g. over a slow SSH session.
+ * Intervals are never stretched beyond the minimum frame rate. Measuring
+ * the queue may cost a system call, so writers only do so when
+ * backlogDue() says so.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // A write that blocks this long means the link cannot keep up
+    static constexpr std::chrono::microseconds slow_write{2000};
+    // Bytes still queued after a write that mean the link cannot keep up
+    static constexpr size_t backlog_bytes = 1024;
+    static constexpr double max_slowdown = 64.0;
+    // Fast writes between two queue measurements while not slowed down
+    static constexpr uint32_t backlog_check_writes = 16;
+
+    FramePacer();
+
+    bool backlogDue(Clock::duration took);
+    void recordWrite(Clock::duration took, size_t pending_bytes);
+    std::chrono::microseconds pace(std::chrono::microseconds interval) const;
+    double rateHz(std::chrono::microseconds interval) const;
+
+    double slowdown() const {
+        return factor.load(std::memory_order_relaxed);
+    }
+
+    void setMinRateHz(double hz);
+    double minRateHz() const {
+        return min_rate_hz.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> factor;
+    std::atomic<double> min_rate_hz;
+    std::atomic<uint32_t> unmeasured_writes;
+};
+
+#endif // PROGRESS_INDICATOR_FRAME_PACER_HPP
@@ -0,0 +1,98 @@
+#ifndef PROGRESS_INDICATOR_FRAME_TRACE_HPP
+#define PROGRESS_INDICATOR_FRAME_TRACE_HPP
+
+#include "output_sink.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * \brief One write recorded in a frame trace.
+ */
+struct TraceFrame {
+    uint64_t time_ns;              // Since the recording started, monotonic
+    std::vector<FrameSpan> spans;  // Source of each part of bytes, in order
+    std::string bytes;
+};
+
+/**
+ * \brief Passes every write on to another sink and records the frames it
+ * delivered into a binary trace file.
+ *
+ * The trace starts with the magic "PITRACE1" and the terminal flag and
+ * width of the target. Every delivered write follows as one record: the
+ * nanoseconds since the previous record, the number of spans, the source id
+ * and size of each span, then the bytes. Numbers are unsigned LEB128
+ * varints, so a typical record adds about six bytes to its payload.
+ *
+ * Put the recorder in front of an AsyncSink, not behind it, to keep the
+ * sources of the bytes.
+ */
+class RecordingSink : public OutputSink {
+public:
+    RecordingSink(std::shared_ptr<OutputSink> target, const std::string& path);
+    ~RecordingSink();
+
+    RecordingSink(const RecordingSink&) = delete;
+    RecordingSink& operator=(const RecordingSink&) = delete;
+
+    bool write(const char* data, size_t size) override;
+    bool writeFrame(const char* data, size_t size, const FrameSpan* spans, size_t span_count) override;
+    void flush() override;
+    bool isTerminal() const override {
+        return target->isTerminal();
+    }
+    size_t columns() const override {
+        return target->columns();
+    }
+    size_t pendingBytes() const override {
+        return target->pendingBytes();
+    }
+
+    uint64_t recordedFrames() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::shared_ptr<OutputSink> target;
+    mutable std::mutex mutex;
+    std::FILE* file;
+    std::string record;
+    Clock::time_point last_record;
+    uint64_t recorded;
+};
+
+/**
+ * \brief Reads the frames of a trace written by a RecordingSink.
+ */
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool next(TraceFrame& frame);
+
+    bool isTerminal() const {
+        return terminal;
+    }
+    size_t columns() const {
+        return terminal_columns;
+    }
+
+private:
+    std::FILE* file;
+    bool terminal;
+    size_t terminal_columns;
+    uint64_t time_ns;
+
+    bool readVarint(uint64_t& value);
+};
+
+#endif // PROGRESS_INDICATOR_FRAME_TRACE_HPP
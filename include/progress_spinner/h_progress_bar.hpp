@@ -1,27 +1,40 @@
 #ifndef PROGRESS_INDICATOR_H_PROGRESS_BAR_HPP
 #define PROGRESS_INDICATOR_H_PROGRESS_BAR_HPP
 
-#include "progress_indicator.hpp"
 #include "options.hpp"
+#include "segment_bar.hpp"
+#include "text_width.hpp"
+#include <vector>
 
-class HProgressBar : public ProgressIndicator {
+class HProgressBar : public SegmentBar {
 public:
     HProgressBar(const HProgressBarOptions& options = HProgressBarOptions());
-
-    void start() override;
-    void stop() override;
-    void updateProgress(double new_percentage);
-    void updateText(const std::string& new_text) override;
+    ~HProgressBar();
 
 private:
+    // Narrowest bar the layout shrinks to before shortening the label
+    static constexpr int min_segments = 10;
+
     int total_segments;
-    int current_segments;
-    option::CharFrames progress_chars;
-    option::CharFrames bracket_chars;
+    int segments;
+    int steps_per_segment;
     // const HProgressBarOptions* options;
     bool use_brackets_flag_;
+    Glyph empty_glyph;
+    Glyph filled_glyph;
+    Glyph open_bracket;
+    Glyph close_bracket;
+    std::vector<Glyph> partial_glyphs;
+    std::string filled_run;
+    std::string empty_run;
+    bool show_stats;
+    size_t layout_columns;
+    uint64_t layout_generation;
+    size_t layout_stats_reserve;
 
-    void redraw(bool is_final = false);
+    size_t barWidth() const;
+    void layout(size_t columns);
+    void composeLine(std::string& line) override;
 };
 
 #endif // PROGRESS_INDICATOR_H_PROGRESS_BAR_HPP
@@ -1,16 +1,55 @@
 #ifndef PROGRESS_INDICATOR_ICONSOLE_HPP
 #define PROGRESS_INDICATOR_ICONSOLE_HPP
 
-#include <iostream>
+#include "output_sink.hpp"
+#include <cstddef>
+#include <memory>
 
+/**
+ * \brief Terminal control on top of the process-wide output sink.
+ *
+ * All consoles write through the same OutputSink, standard output unless
+ * replaced with setSink().
+ */
 class IConsole {
 public:
     virtual ~IConsole() = default;
     virtual void clearLine() const {
-        std::cout << "\r\033[K";
+        if (isTerminal()) {
+            write("\r\033[K", 4);
+        }
     }
     virtual void showCursor(bool show_flag) const = 0;
 
+    bool isTerminal() const;
+    size_t columns() const;
+    size_t pendingBytes() const;
+    bool write(const char* data, size_t size) const;
+    bool writeFrame(const char* data, size_t size, const FrameSpan* spans, size_t span_count) const;
+    void flush() const;
+
+    static std::shared_ptr<OutputSink> sink();
+    static void setSink(std::shared_ptr<OutputSink> new_sink);
+
+    /**
+     * \brief Keeps the current sink for every console call of this thread
+     * while it is in scope, so a frame loads the shared sink only once.
+     *
+     * Scopes nest; inner ones use the sink of the outermost. A sink
+     * installed meanwhile is used from the next scope on.
+     */
+    class FrameScope {
+    public:
+        FrameScope();
+        ~FrameScope();
+
+        FrameScope(const FrameScope&) = delete;
+        FrameScope& operator=(const FrameScope&) = delete;
+
+    private:
+        std::shared_ptr<OutputSink> held;
+    };
+
 protected:
     IConsole() = default;
 };
@@ -0,0 +1,143 @@
+#ifndef PROGRESS_INDICATOR_INDICATOR_STATS_HPP
+#define PROGRESS_INDICATOR_INDICATOR_STATS_HPP
+
+#include "sharded_counter.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * \brief Snapshot of the self-instrumentation counters of one indicator.
+ *
+ * Bucket i of the latency histogram counts frames that reached the sink
+ * less than 2^i microseconds after they were due; the last bucket also
+ * counts everything slower.
+ */
+struct IndicatorStats {
+    static const size_t latency_buckets = 24;
+
+    uint64_t updates = 0;
+    uint64_t frames_rendered = 0;
+    uint64_t frames_skipped = 0;
+    uint64_t bytes_written = 0;
+    uint64_t mutex_hold_ns = 0;
+    std::array<uint64_t, latency_buckets> latency_histogram{};
+
+    double latencyPercentileUs(double fraction) const;
+    std::string toString() const;
+};
+
+/**
+ * \brief Counters behind IndicatorStats.
+ *
+ * Every counter is a relaxed atomic, so stats() can be read from any thread
+ * while the indicator is in use. Only countUpdate() is on the producer's
+ * path; everything else is counted while drawing. Each producer thread
+ * counts its updates in a cache line of its own, found through a small
+ * thread-local cache, so that measuring the updates neither bounces a cache
+ * line between cores nor loses counts.
+ */
+class IndicatorCounters {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    IndicatorCounters();
+    ~IndicatorCounters();
+
+    IndicatorCounters(const IndicatorCounters&) = delete;
+    IndicatorCounters& operator=(const IndicatorCounters&) = delete;
+
+    // Only the calling thread writes its cell, so a plain load and store
+    // counts every update without a locked instruction
+    void countUpdate() {
+        UpdateCell& cell = threadCell();
+        cell.count.store(cell.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void countFrame(size_t bytes) {
+        frames_rendered.fetch_add(1, std::memory_order_relaxed);
+        bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void countSkipped() {
+        frames_skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void countHoldTime(Clock::duration held) {
+        mutex_hold_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(held).count()),
+                                std::memory_order_relaxed);
+    }
+
+    void countLatency(Clock::duration latency);
+    IndicatorStats snapshot() const;
+
+private:
+    /**
+     * \brief Updates counted by one thread.
+     */
+    struct alignas(cache_line_size) UpdateCell {
+        std::atomic<uint64_t> count{0};
+        std::thread::id thread;
+        UpdateCell* next = nullptr;
+    };
+
+    struct CachedCell {
+        uint64_t owner = 0;
+        UpdateCell* cell = nullptr;
+    };
+
+    // Cells a thread remembers; counters it updates in turn rarely collide
+    static constexpr size_t cached_cells = 8;
+
+    UpdateCell& threadCell() {
+        thread_local CachedCell cache[cached_cells];
+        CachedCell& cached = cache[counters_id % cached_cells];
+        if (cached.owner != counters_id) {
+            cached.owner = counters_id;
+            cached.cell = &findCell();
+        }
+        return *cached.cell;
+    }
+
+    UpdateCell& findCell();
+
+    const uint64_t counters_id;
+    std::atomic<UpdateCell*> update_cells;
+    alignas(cache_line_size) std::atomic<uint64_t> frames_rendered;
+    std::atomic<uint64_t> frames_skipped;
+    std::atomic<uint64_t> bytes_written;
+    std::atomic<uint64_t> mutex_hold_ns;
+    std::array<std::atomic<uint64_t>, IndicatorStats::latency_buckets> latency_histogram;
+};
+
+/**
+ * \brief Scoped lock that adds the time the mutex was held to the counters.
+ */
+class TimedLock {
+public:
+    TimedLock(std::mutex& mutex, IndicatorCounters& counters)
+        : mutex(mutex), counters(counters) {
+        mutex.lock();
+        locked_at = IndicatorCounters::Clock::now();
+    }
+
+    ~TimedLock() {
+        counters.countHoldTime(IndicatorCounters::Clock::now() - locked_at);
+        mutex.unlock();
+    }
+
+    TimedLock(const TimedLock&) = delete;
+    TimedLock& operator=(const TimedLock&) = delete;
+
+private:
+    std::mutex& mutex;
+    IndicatorCounters& counters;
+    IndicatorCounters::Clock::time_point locked_at;
+};
+
+#endif // PROGRESS_INDICATOR_INDICATOR_STATS_HPP
@@ -0,0 +1,37 @@
+#ifndef PROGRESS_INDICATOR_LOG_LINE_HPP
+#define PROGRESS_INDICATOR_LOG_LINE_HPP
+
+#include <chrono>
+#include <string>
+
+/**
+ * \brief Line-oriented output for consoles that are not terminals.
+ *
+ * Where ScreenLine redraws a line in place, LogLine prints a new plain line,
+ * without any control sequences, and only when one is due: the first line,
+ * once the interval has passed since the last line, when the progress
+ * reaches the next percent step, and the final line. Log volume is then
+ * bounded by time and by progress rather than by the number of updates.
+ */
+class LogLine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    LogLine(int interval_sec = 10, int percent_step = 10);
+
+    void update(const std::string& line, double percentage, std::string& frame);
+    void finish(const std::string& line, std::string& frame);
+
+private:
+    std::chrono::seconds interval;
+    int percent_step;
+    std::string logged;
+    Clock::time_point logged_at;
+    int logged_step;
+    bool has_logged;
+
+    int stepOf(double percentage) const;
+    void log(const std::string& line, int step, Clock::time_point now, std::string& frame);
+};
+
+#endif // PROGRESS_INDICATOR_LOG_LINE_HPP
@@ -0,0 +1,112 @@
+#ifndef PROGRESS_INDICATOR_MULTI_PROGRESS_HPP
+#define PROGRESS_INDICATOR_MULTI_PROGRESS_HPP
+
+#include "progress_indicator.hpp"
+#include "options.hpp"
+#include "stream_capture.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * \brief Draws several indicators as a block of lines, one row each.
+ *
+ * Rows are created through add() and never write to the console themselves;
+ * their updates only change state. The block is redrawn by the
+ * RenderScheduler at the configured rate in a single write; only the rows,
+ * and within them the cells, that changed since the last frame are emitted.
+ * Lines logged with println() are printed above the block by the same write;
+ * with option::CaptureStreams, so are the lines written to std::cout and
+ * std::cerr.
+ */
+class MultiProgress : public Renderable {
+public:
+    MultiProgress(const MultiProgressOptions& options = MultiProgressOptions());
+    ~MultiProgress();
+
+    template <typename Indicator, typename Options>
+    Indicator& add(const Options& options);
+
+    void start();
+    void stop();
+    void println(const std::string& text);
+    double frameRateHz() const;
+
+private:
+    struct LogMessage {
+        std::string text;
+        LogMessage* next;
+    };
+
+    // A row drawn into the frame in flight, and where its bytes are
+    struct DrawnRow {
+        size_t row;
+        size_t offset;  // From the start of the block's part of the frame
+        size_t bytes;
+    };
+
+    struct ManagedScope {
+        ManagedScope() { ProgressIndicator::constructing_managed = true; }
+        ~ManagedScope() { ProgressIndicator::constructing_managed = false; }
+    };
+
+    std::mutex mutex;
+    Console console;
+    std::vector<std::unique_ptr<ProgressIndicator>> rows;
+    std::vector<std::string> lines;
+    std::vector<ScreenLine> screen_lines;
+    std::vector<DrawnRow> drawn_in_frame;
+    // Where the block's part of the frame in flight starts
+    size_t frame_start;
+    std::string frame_buffer;
+    int refresh_rate_hz;
+    bool capture_streams;
+    std::unique_ptr<StreamCapture> captured_out;
+    std::unique_ptr<StreamCapture> captured_err;
+    size_t drawn_rows;
+    size_t previous_drawn_rows;
+    std::atomic<LogMessage*> pending_logs;
+    std::string log_text;
+    std::atomic<bool> running;
+
+    void append(std::unique_ptr<ProgressIndicator> row);
+    void renderFrame(std::string& frame) override;
+    void frameWritten(std::chrono::steady_clock::duration latency) override;
+    void frameDropped() override;
+    void frameSpans(size_t size, std::vector<FrameSpan>& frame_spans) override;
+    void takeLogs();
+    void appendLogs(std::string& frame);
+    void composeBlock(std::string& frame);
+    void logLines(std::string& frame);
+    void logFinalLines(std::string& frame);
+    void countRowFrame(size_t row, size_t start, size_t end);
+    void appendSpans(size_t size, std::vector<FrameSpan>& frame_spans) const;
+    void countDrawnRows();
+};
+
+/**
+ * \brief Creates a new row at the bottom of the block.
+ *
+ * The indicator is constructed in managed mode, so it neither draws nor
+ * registers with the scheduler on its own. It still has to be started and
+ * stopped like a standalone indicator; a stopped row shows its completed
+ * label.
+ *
+ * \param options Options passed to the indicator's constructor.
+ * \return The new row, owned by this MultiProgress.
+ */
+template <typename Indicator, typename Options>
+Indicator& MultiProgress::add(const Options& options) {
+    std::unique_ptr<Indicator> row;
+    {
+        ManagedScope scope;
+        row.reset(new Indicator(options));
+    }
+    Indicator& indicator = *row;
+    append(std::move(row));
+    return indicator;
+}
+
+#endif // PROGRESS_INDICATOR_MULTI_PROGRESS_HPP
@@ -41,6 +41,18 @@ struct BracketChars : public CharFrames {
     BracketChars(const std::initializer_list<std::string>& char_list) : CharFrames(char_list) {}
 };
 
+/**
+ * \brief Glyphs for partially filled segments, from least to most filled.
+ *
+ * The fully filled glyph is not part of the ramp. With n glyphs, every
+ * segment shows n + 1 steps of progress, e.g. {"▏", "▎", "▍", "▌", "▋", "▊", "▉"}
+ * together with "█" gives eight steps per segment. Empty (the default)
+ * disables partial segments.
+ */
+struct PartialChars : public CharFrames {
+    PartialChars(const std::initializer_list<std::string>& char_list = {}) : CharFrames(char_list) {}
+};
+
 struct UseBrackets {
     bool use_brackets = false;
 };
@@ -49,6 +61,84 @@ struct UpdateIntervalMs {
     int update_interval_ms = 100;
 };
 
+/**
+ * \brief Maximum number of redraws per second for progress bars.
+ *
+ * 0 (the default) redraws synchronously on every update. A positive rate
+ * makes updates a plain atomic store and leaves drawing to a renderer that
+ * runs at most this many times per second.
+ */
+struct RefreshRateHz {
+    int refresh_rate_hz = 0;
+};
+
+/**
+ * \brief Minimum seconds between two progress lines when standard output is
+ * not a terminal.
+ *
+ * Without a terminal, indicators print plain lines instead of redrawing in
+ * place. 0 disables lines driven by time.
+ */
+struct LogIntervalSec {
+    int log_interval_sec = 10;
+};
+
+/**
+ * \brief Progress step, in percent, that always gets a plain line when
+ * standard output is not a terminal.
+ *
+ * 0 disables lines driven by progress.
+ */
+struct LogPercentStep {
+    int log_percent_step = 10;
+};
+
+/**
+ * \brief Largest number of items track() counts locally before publishing
+ * them to the bar.
+ */
+struct BatchItems {
+    int batch_items = 4096;
+};
+
+/**
+ * \brief Milliseconds after which track() publishes the items counted so
+ * far, however few.
+ */
+struct PublishIntervalMs {
+    int publish_interval_ms = 20;
+};
+
+/**
+ * \brief Whether a MultiProgress captures std::cout and std::cerr while it
+ * runs, printing their lines above the block.
+ */
+struct CaptureStreams {
+    bool capture_streams = false;
+};
+
+/**
+ * \brief Number of tasks a TaskTable shows a row for.
+ */
+struct TopTasks {
+    int top_tasks = 5;
+};
+
+/**
+ * \brief Which running tasks a TaskTable picks for its rows.
+ */
+struct TaskOrder {
+    enum Order { MostActive, Slowest };
+    Order task_order = MostActive;
+};
+
+/**
+ * \brief Milliseconds between two snapshots of a ProgressExporter.
+ */
+struct ExportIntervalMs {
+    int export_interval_ms = 1000;
+};
+
 } // namespace option
 
 struct ProgressSpinnerOptions {
@@ -56,11 +146,13 @@ struct ProgressSpinnerOptions {
     std::string completed_label;
     option::CharFrames chars;
     int update_interval_ms;
+    int log_interval_sec;
 
     ProgressSpinnerOptions(const option::Label& label = option::Label(),
                            const option::CompletedLabel& completed_label = option::CompletedLabel(),
                            const option::CharFrames& char_frames = option::CharFrames({"|", "/", "-", "\\"}),
-                           const option::UpdateIntervalMs& update_interval_ms = option::UpdateIntervalMs());
+                           const option::UpdateIntervalMs& update_interval_ms = option::UpdateIntervalMs(),
+                           const option::LogIntervalSec& log_interval = option::LogIntervalSec());
 };
 
 struct HProgressBarOptions {
@@ -69,22 +161,53 @@ struct HProgressBarOptions {
     int total_segments;
     option::ProgressChars progress_chars;
     option::BracketChars bracket_chars;
+    int refresh_rate_hz;
+    option::PartialChars partial_chars;
+    int log_interval_sec;
+    int log_percent_step;
 
     HProgressBarOptions(const option::Label& label = option::Label(),
                         const option::CompletedLabel& completed_label = option::CompletedLabel(),
                         const option::NumOfSegments& segments = option::NumOfSegments{30},
                         const option::ProgressChars& progress_chars = option::ProgressChars({"░", "█"}),
-                        const option::BracketChars& bracket_chars = option::BracketChars({"", ""}));
+                        const option::BracketChars& bracket_chars = option::BracketChars({"", ""}),
+                        const option::RefreshRateHz& refresh_rate = option::RefreshRateHz(),
+                        const option::PartialChars& partial_chars = option::PartialChars(),
+                        const option::LogIntervalSec& log_interval = option::LogIntervalSec(),
+                        const option::LogPercentStep& log_step = option::LogPercentStep());
 
     bool has_brackets() const {
         return bracket_chars.size() == 2 && !bracket_chars[0].empty() && !bracket_chars[1].empty();
     }
 };
 
+/**
+ * \brief Runtime options of BasicHProgressBar.
+ *
+ * Width and glyphs are template parameters of the bar, so only the labels
+ * and the timing are left here.
+ */
+struct BasicHProgressBarOptions {
+    std::string progress_label;
+    std::string completed_label;
+    int refresh_rate_hz;
+    int log_interval_sec;
+    int log_percent_step;
+
+    BasicHProgressBarOptions(const option::Label& label = option::Label(),
+                             const option::CompletedLabel& completed_label = option::CompletedLabel(),
+                             const option::RefreshRateHz& refresh_rate = option::RefreshRateHz(),
+                             const option::LogIntervalSec& log_interval = option::LogIntervalSec(),
+                             const option::LogPercentStep& log_step = option::LogPercentStep());
+};
+
 struct VProgressBarOptions {
     std::string progress_label;
     std::string completed_label;
     option::CharFrames chars;
+    int refresh_rate_hz;
+    int log_interval_sec;
+    int log_percent_step;
 
     /**
      * \brief Constructor for VProgressBarOptions.
@@ -96,10 +219,76 @@ struct VProgressBarOptions {
      *                    segments, and subsequent characters are used for filled
      *                    segments. If the sequence is empty, the default of " ",
      *                    "▁", "▂", "▃", "▄", "▅", "▆", "▇", and "█" is used.
+     * \param refresh_rate Maximum redraws per second, or 0 to redraw on every
+     *                     update.
+     * \param log_interval Seconds between plain lines without a terminal.
+     * \param log_step Percent step that gets a plain line without a terminal.
      */
     VProgressBarOptions(const option::Label& label = option::Label(),
                         const option::CompletedLabel& completed_label = option::CompletedLabel(),
-                        const option::CharFrames& char_frames = option::CharFrames({" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"}));
+                        const option::CharFrames& char_frames = option::CharFrames({" ", "▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"}),
+                        const option::RefreshRateHz& refresh_rate = option::RefreshRateHz(),
+                        const option::LogIntervalSec& log_interval = option::LogIntervalSec(),
+                        const option::LogPercentStep& log_step = option::LogPercentStep());
+};
+
+struct TrackOptions {
+    int batch_items;
+    int publish_interval_ms;
+
+    TrackOptions(const option::BatchItems& batch = option::BatchItems(),
+                 const option::PublishIntervalMs& publish_interval = option::PublishIntervalMs());
+};
+
+struct MultiProgressOptions {
+    int refresh_rate_hz;
+    bool capture_streams;
+
+    /**
+     * \brief Constructor for MultiProgressOptions.
+     *
+     * \param refresh_rate Maximum redraws per second of the whole block; must be
+     *                     positive.
+     * \param capture_streams Whether to capture std::cout and std::cerr while
+     *                        the block runs.
+     */
+    MultiProgressOptions(const option::RefreshRateHz& refresh_rate = option::RefreshRateHz{30},
+                         const option::CaptureStreams& capture_streams = option::CaptureStreams());
+};
+
+struct TaskTableOptions {
+    int top_tasks;
+    option::TaskOrder::Order task_order;
+    int refresh_rate_hz;
+    int log_interval_sec;
+
+    /**
+     * \brief Constructor for TaskTableOptions.
+     *
+     * \param top_tasks Rows for single tasks below the summary line; must not
+     *                  be negative.
+     * \param task_order Whether the rows show the most active or the slowest
+     *                   running tasks.
+     * \param refresh_rate Maximum redraws per second; must be positive.
+     * \param log_interval Seconds between two summary lines when standard
+     *                     output is not a terminal; 0 prints one at stop only.
+     */
+    TaskTableOptions(const option::TopTasks& top_tasks = option::TopTasks(),
+                     const option::TaskOrder& task_order = option::TaskOrder(),
+                     const option::RefreshRateHz& refresh_rate = option::RefreshRateHz{10},
+                     const option::LogIntervalSec& log_interval = option::LogIntervalSec());
+};
+
+struct ProgressExporterOptions {
+    int export_interval_ms;
+
+    /**
+     * \brief Constructor for ProgressExporterOptions.
+     *
+     * \param export_interval Milliseconds between two snapshots; must be
+     *                        positive.
+     */
+    ProgressExporterOptions(const option::ExportIntervalMs& export_interval = option::ExportIntervalMs());
 };
 
 #endif // PROGRESS_INDICATOR_OPTIONS_HPP
@@ -0,0 +1,186 @@
+#ifndef PROGRESS_INDICATOR_OUTPUT_SINK_HPP
+#define PROGRESS_INDICATOR_OUTPUT_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Bytes of a write that one source produced.
+ *
+ * The source is the id() of the ProgressIndicator that composed them, or 0
+ * for anything else, such as a MultiProgress block.
+ */
+struct FrameSpan {
+    uint64_t source_id;
+    size_t size;
+};
+
+/**
+ * \brief Destination of the bytes the consoles write.
+ *
+ * A write either delivers the whole frame or drops it. Callers treat a
+ * dropped frame as never written and redraw from scratch on the next frame.
+ */
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    virtual bool write(const char* data, size_t size) = 0;
+    // Like write(), telling which source produced which bytes; spans cover
+    // the data in order. Only sinks that record frames look at them.
+    virtual bool writeFrame(const char* data, size_t size, const FrameSpan* spans, size_t span_count) {
+        (void)spans;
+        (void)span_count;
+        return write(data, size);
+    }
+    virtual void flush() {}
+    virtual bool isTerminal() const {
+        return false;
+    }
+    // Terminal width in cells; 0 if unknown or not a terminal
+    virtual size_t columns() const {
+        return 0;
+    }
+    // Bytes accepted but not yet delivered; 0 if unknown
+    virtual size_t pendingBytes() const {
+        return 0;
+    }
+
+protected:
+    OutputSink() = default;
+};
+
+/**
+ * \brief Writes synchronously to a file descriptor, by default standard output.
+ *
+ * The terminal width is cached and only queried again after the terminal
+ * was resized, which is signalled with SIGWINCH on Unix-like systems.
+ *
+ * Frames bypass std::cout. On standard output, text buffered in std::cout
+ * is flushed when the sink is created and flushed, i.e. before an
+ * indicator starts drawing and before final lines, not before every frame.
+ * Text printed while indicators draw should go through
+ * MultiProgress::println() or option::CaptureStreams.
+ */
+class FdSink : public OutputSink {
+public:
+    explicit FdSink(int fd = 1);
+
+    bool write(const char* data, size_t size) override;
+    void flush() override;
+    bool isTerminal() const override {
+        return terminal;
+    }
+    size_t columns() const override;
+    size_t pendingBytes() const override;
+
+private:
+    int fd;
+    bool terminal;
+    mutable std::atomic<size_t> cached_columns;
+    mutable std::atomic<uint64_t> measured_at;
+
+    size_t queryColumns() const;
+};
+
+/**
+ * \brief Collects everything written in memory, e.g. for tests and benchmarks.
+ */
+class MemorySink : public OutputSink {
+public:
+    explicit MemorySink(bool terminal = true, size_t columns = 0);
+
+    bool write(const char* data, size_t size) override;
+    bool isTerminal() const override {
+        return terminal;
+    }
+    size_t columns() const override {
+        return terminal_columns.load(std::memory_order_relaxed);
+    }
+    void setColumns(size_t columns) {
+        terminal_columns.store(columns, std::memory_order_relaxed);
+    }
+    size_t pendingBytes() const override {
+        return pending_bytes.load(std::memory_order_relaxed);
+    }
+    void setPendingBytes(size_t bytes) {
+        pending_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    std::string contents() const;
+    void clear();
+
+private:
+    mutable std::mutex mutex;
+    std::string buffer;
+    bool terminal;
+    std::atomic<size_t> terminal_columns;
+    std::atomic<size_t> pending_bytes;
+};
+
+/**
+ * \brief Hands frames to a writer thread that writes them to another sink.
+ *
+ * Frames are copied into a bounded ring of preallocated slots without
+ * taking a lock. When the target stalls and the ring is full, new frames
+ * are dropped instead of blocking the caller, which then redraws in full
+ * once the writer has caught up.
+ */
+class AsyncSink : public OutputSink {
+public:
+    explicit AsyncSink(std::shared_ptr<OutputSink> target, size_t slots = 16);
+    ~AsyncSink();
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    bool write(const char* data, size_t size) override;
+    void flush() override;
+    bool isTerminal() const override {
+        return target->isTerminal();
+    }
+    size_t columns() const override {
+        return target->columns();
+    }
+    size_t pendingBytes() const override {
+        return queued_bytes.load(std::memory_order_relaxed) + target->pendingBytes();
+    }
+
+    uint64_t droppedFrames() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        std::string frame;
+    };
+
+    std::shared_ptr<OutputSink> target;
+    std::vector<Slot> ring;
+    size_t mask;
+    std::atomic<size_t> enqueue_pos;
+    size_t dequeue_pos;
+    std::atomic<uint64_t> dropped;
+    std::atomic<size_t> queued_bytes;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::atomic<bool> sleeping;
+    uint64_t written;
+    bool running;
+    std::thread writer_thread;
+
+    bool pop(std::string& frame);
+    void run();
+};
+
+#endif // PROGRESS_INDICATOR_OUTPUT_SINK_HPP
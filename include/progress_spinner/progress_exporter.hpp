@@ -0,0 +1,94 @@
+#ifndef PROGRESS_INDICATOR_PROGRESS_EXPORTER_HPP
+#define PROGRESS_INDICATOR_PROGRESS_EXPORTER_HPP
+
+#include "options.hpp"
+#include "progress_snapshot.hpp"
+#include "render_scheduler.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * \brief Where a ProgressExporter writes its snapshots.
+ */
+struct ExportTarget {
+    enum class Kind { Fd, UnixSocket, Textfile };
+
+    Kind kind;
+    int fd;
+    std::string path;
+
+    static ExportTarget fileDescriptor(int fd);
+    static ExportTarget unixSocket(const std::string& path);
+    static ExportTarget textfile(const std::string& path);
+};
+
+/**
+ * \brief Writes the state of every live indicator as JSON Lines, for
+ * programs that watch a job rather than a person.
+ *
+ * Each snapshot has one line per indicator with its id, label, state,
+ * done/total, percentage, rate and ETA. Snapshots are taken on the shared
+ * RenderScheduler thread at the export interval, so exporting adds nothing
+ * to the cost of reporting progress. The render thread never blocks on the
+ * target: a file descriptor or a Unix domain socket receives every snapshot
+ * it has room for, and a textfile is written by a thread of its own. The
+ * textfile always holds the latest snapshot and is replaced atomically, so
+ * readers never see a partial snapshot.
+ */
+class ProgressExporter : public Renderable {
+public:
+    explicit ProgressExporter(const ExportTarget& target,
+                              const ProgressExporterOptions& options = ProgressExporterOptions());
+    ~ProgressExporter();
+
+    ProgressExporter(const ProgressExporter&) = delete;
+    ProgressExporter& operator=(const ProgressExporter&) = delete;
+
+    void start();
+    void stop();
+
+    uint64_t snapshotsWritten() const {
+        return written.load(std::memory_order_relaxed);
+    }
+
+    uint64_t snapshotsDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    ExportTarget target;
+    int interval_ms;
+    int socket_fd;
+    int fd_flags;
+    uint64_t sequence;
+    std::string buffer;
+    // Tail of a snapshot the descriptor took only in part
+    std::string unsent;
+    std::mutex mutex;
+    bool running;
+    std::atomic<uint64_t> written;
+    std::atomic<uint64_t> dropped;
+
+    // Latest snapshot for the textfile writer thread
+    std::mutex textfile_mutex;
+    std::condition_variable textfile_wake;
+    std::string textfile_snapshot;
+    bool textfile_pending;
+    bool textfile_running;
+    std::thread textfile_thread;
+
+    void renderFrame(std::string& frame) override;
+    void exportSnapshot();
+    bool deliver();
+    bool writeToFd();
+    bool sendToSocket();
+    void queueTextfile();
+    void runTextfileWriter();
+    bool replaceTextfile(const std::string& snapshot);
+};
+
+#endif // PROGRESS_INDICATOR_PROGRESS_EXPORTER_HPP
@@ -1,28 +1,125 @@
 #ifndef PROGRESS_INDICATOR_PROGRESS_INDICATOR_HPP
 #define PROGRESS_INDICATOR_PROGRESS_INDICATOR_HPP
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <mutex>
+#include <vector>
 #include "iconsole.hpp"
+#include "indicator_stats.hpp"
+#include "log_line.hpp"
+#include "progress_snapshot.hpp"
+#include "render_scheduler.hpp"
+#include "screen_line.hpp"
+#include "work_progress.hpp"
 
-class ProgressIndicator {
+class MultiProgress;
+
+class ProgressIndicator : public Renderable {
 public:
     ProgressIndicator(const std::string& progress_label = "Progress: ",
                       const std::string& completed_label = " ✓ OK!");
-    virtual ~ProgressIndicator() = default;
+    virtual ~ProgressIndicator();
 
     virtual void start() = 0;
     virtual void stop() = 0;
 
     virtual void updateText(const std::string& new_text);
 
+    void pause();
+    void resume();
+    void setHidden(bool hide);
+    double frameRateHz();
+
+    IndicatorStats stats() const;
+    static void setStatsOnStop(bool enabled);
+
+    uint64_t id() const {
+        return indicator_id;
+    }
+    ProgressSnapshot snapshot();
+    static std::vector<ProgressSnapshot> snapshotAll();
+
 protected:
     std::string progress_label, completed_label;
     std::mutex mutex;
+    IndicatorCounters counters;
     Console console;
+    bool managed;
+    bool dirty;
+    ScreenLine screen_line;
+    LogLine log_line;
+    std::string line;
+    std::string frame_buffer;
+    IndicatorCounters::Clock::time_point frame_started;
+    uint64_t label_generation;
+    uint64_t source_label_generation;
 
     void showCursor(bool show_flag);
     void clearLine();
+    void setLabel(const std::string& new_label);
+    size_t labelWidth();
+    size_t completedWidth() const {
+        return completed_width;
+    }
+    const std::string& fittedLabel(size_t columns, size_t reserved);
+    void adoptSourceLabel(const ProgressSource& source);
+
+    static bool fitsLine(size_t columns, size_t cells) {
+        return columns == 0 || cells < columns;
+    }
+    void composeFrame(std::string& frame);
+    void drawFrame();
+    void composeFinalFrame(std::string& frame);
+    void countEmptyFrame(size_t bytes);
+    void writeFrame(const std::string& frame);
+    void writeFinalFrame(const std::string& frame);
+    void dumpStats();
+    void registerIndicator();
+    void retireIndicator();
+    void unregisterIndicator();
+    virtual void fillSnapshot(ProgressSnapshot& snapshot);
+
+    void startRenderer(std::chrono::microseconds interval);
+    void stopRenderer();
+    void redrawNow();
+    void renderFrame(std::string& frame) override;
+    void frameWritten(std::chrono::steady_clock::duration latency) override;
+    void frameDropped() override;
+    uint64_t frameSourceId() const override {
+        return indicator_id;
+    }
+    virtual void discardFrame();
+    virtual void composeRefreshed(std::string& frame);
+    virtual bool refresh();
+    virtual double shownPercentage() const;
+    virtual void composeLine(std::string& line) = 0;
+
+private:
+    friend class MultiProgress;
+
+    static thread_local bool constructing_managed;
+    static std::atomic<bool> stats_on_stop;
+
+    void updateSchedule();
+    bool throttled() const;
+    void deliverFrame(const std::string& frame);
+    uint64_t indicator_id;
+    bool scheduled;
+    bool paused;
+    bool hidden;
+    std::chrono::microseconds render_interval;
+    IndicatorCounters::Clock::time_point last_write;
+    // Size of the last frame renderFrame() added; scheduler thread only
+    size_t rendered_bytes;
+    size_t label_width;
+    uint64_t measured_generation;
+    size_t completed_width;
+    std::string fitted_label;
+    std::string source_label;
+    uint64_t fitted_generation;
+    size_t fitted_available;
 };
 
 #endif // PROGRESS_INDICATOR_PROGRESS_INDICATOR_HPP
@@ -4,7 +4,16 @@
 #include "progress_indicator.hpp"
 #include "v_progress_bar.hpp"
 #include "h_progress_bar.hpp"
+#include "basic_h_progress_bar.hpp"
 #include "progress_spinner.hpp"
+#include "multi_progress.hpp"
+#include "track.hpp"
+#include "sharded_counter.hpp"
+#include "task_tree.hpp"
+#include "task_table.hpp"
+#include "shared_progress.hpp"
+#include "progress_exporter.hpp"
+#include "frame_trace.hpp"
 #include "options.hpp"
 
 #endif // PROGRESS_INDICATOR_PROGRESS_INDICATORS_HPP
@@ -0,0 +1,32 @@
+#ifndef PROGRESS_INDICATOR_PROGRESS_SNAPSHOT_HPP
+#define PROGRESS_INDICATOR_PROGRESS_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief State of one indicator at one point in time, for export.
+ *
+ * Fields an indicator does not know keep their defaults: a spinner has no
+ * done or total count, and the rate and ETA are only known once the bar has
+ * measured its throughput.
+ */
+struct ProgressSnapshot {
+    enum class State { Running, Paused, Hidden, Done };
+
+    uint64_t id = 0;
+    std::string label;
+    State state = State::Running;
+    uint64_t done = 0;
+    uint64_t total = 0;
+    // Negative for indicators that show no percentage, such as spinners
+    double percentage = -1.0;
+    // Units per second; 0 until measured
+    double rate = 0.0;
+    // Seconds until done; negative if unknown
+    double eta_seconds = -1.0;
+
+    static const char* stateName(State state);
+};
+
+#endif // PROGRESS_INDICATOR_PROGRESS_SNAPSHOT_HPP
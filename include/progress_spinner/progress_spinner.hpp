@@ -3,8 +3,7 @@
 
 #include "progress_indicator.hpp"
 #include "options.hpp"
-#include <atomic>
-#include <thread>
+#include <chrono>
 
 class ProgressSpinner : public ProgressIndicator {
 public:
@@ -16,12 +15,15 @@ public:
 
 private:
     option::CharFrames chars;
-    std::atomic<bool> keep_alive;
-    std::thread spinner_thread;
+    size_t frame_index;
+    size_t glyph_width;
     int update_interval_ms;
+    std::chrono::steady_clock::time_point started_at;
     bool stopped;
 
-    void run();
+    bool refresh() override;
+    void composeLine(std::string& line) override;
+    void fillSnapshot(ProgressSnapshot& snapshot) override;
 };
 
 #endif // PROGRESS_INDICATOR_PROGRESS_SPINNER_HPP
@@ -0,0 +1,97 @@
+#ifndef PROGRESS_INDICATOR_RENDER_SCHEDULER_HPP
+#define PROGRESS_INDICATOR_RENDER_SCHEDULER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "frame_pacer.hpp"
+#include "iconsole.hpp"
+
+/**
+ * \brief Anything the RenderScheduler can draw.
+ */
+class Renderable {
+public:
+    virtual ~Renderable() = default;
+
+protected:
+    friend class RenderScheduler;
+
+    virtual void renderFrame(std::string& frame) = 0;
+    virtual void frameWritten(std::chrono::steady_clock::duration latency) {
+        (void)latency;
+    }
+    virtual void frameDropped() {}
+    // Source id recorded for the bytes renderFrame() appends, see FrameSpan
+    virtual uint64_t frameSourceId() const {
+        return 0;
+    }
+    // Appends the sources of the size bytes the last renderFrame() appended
+    virtual void frameSpans(size_t size, std::vector<FrameSpan>& frame_spans) {
+        frame_spans.push_back(FrameSpan{frameSourceId(), size});
+    }
+};
+
+/**
+ * \brief Process-wide timer that drives every deferred indicator.
+ *
+ * A single thread wakes up when the next indicator is due, collects the
+ * frames of all due indicators into one buffer and writes it in one go, so
+ * the number of threads does not grow with the number of live indicators.
+ * The batch is written without the scheduler lock, so a stalled terminal
+ * does not block add() and remove() for indicators that are not in it.
+ * While the output is backed up, the pacer stretches every interval.
+ */
+class RenderScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static RenderScheduler& instance();
+
+    RenderScheduler(const RenderScheduler&) = delete;
+    RenderScheduler& operator=(const RenderScheduler&) = delete;
+    ~RenderScheduler();
+
+    void add(Renderable* renderable, std::chrono::microseconds interval);
+    void remove(Renderable* renderable);
+
+    FramePacer& pacer() {
+        return frame_pacer;
+    }
+
+private:
+    struct Entry {
+        Renderable* renderable;
+        std::chrono::microseconds interval;
+        Clock::time_point next_due;
+    };
+
+    struct Rendered {
+        Renderable* renderable;
+        Clock::time_point due;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    // Signalled when the batch in flight has been written
+    std::condition_variable written;
+    std::vector<Entry> entries;
+    std::string batch;
+    std::vector<Rendered> rendered;
+    std::vector<FrameSpan> spans;
+    Console console;
+    FramePacer frame_pacer;
+    std::thread timer_thread;
+    bool running;
+    bool writing;
+    // Set by add(), so that a pass started before it does not oversleep
+    bool added;
+
+    RenderScheduler();
+    void run();
+};
+
+#endif // PROGRESS_INDICATOR_RENDER_SCHEDULER_HPP
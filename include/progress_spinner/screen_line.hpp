@@ -0,0 +1,34 @@
+#ifndef PROGRESS_INDICATOR_SCREEN_LINE_HPP
+#define PROGRESS_INDICATOR_SCREEN_LINE_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * \brief Back buffer for one console line.
+ *
+ * Remembers the content last emitted for a line, so that a new version of
+ * the line can be drawn by repositioning the cursor and writing only the
+ * cells that changed. Lines hold printable text only, no control sequences.
+ */
+class ScreenLine {
+public:
+    ScreenLine();
+
+    bool shows(const std::string& line) const {
+        return valid && line == shown;
+    }
+
+    void update(const std::string& line, std::string& frame);
+    void invalidate();
+
+    static void appendCursorMove(std::string& frame, size_t count, char direction);
+    static void moveToRow(std::string& frame, size_t drawn_rows, size_t& cursor_row, size_t row);
+
+private:
+    std::string shown;
+    size_t shown_width;
+    bool valid;
+};
+
+#endif // PROGRESS_INDICATOR_SCREEN_LINE_HPP
@@ -0,0 +1,38 @@
+#ifndef PROGRESS_INDICATOR_SEGMENT_BAR_HPP
+#define PROGRESS_INDICATOR_SEGMENT_BAR_HPP
+
+#include "work_progress_indicator.hpp"
+#include <string>
+
+/**
+ * \brief Base of the horizontal bars, which fill a row of segments.
+ *
+ * Holds the filled units and the finished state of HProgressBar and
+ * BasicHProgressBar and runs their start, stop and refresh. A unit is one
+ * step of a segment: a whole segment without partial glyphs, or one glyph
+ * of the partial ramp with them. The bars only compose the line.
+ */
+class SegmentBar : public WorkProgressIndicator {
+public:
+    void start() override;
+    void stop() override;
+
+protected:
+    SegmentBar(const std::string& progress_label, const std::string& completed_label, int refresh_rate_hz,
+               int total_units);
+
+    // Units of a full bar; changes when HProgressBar fits its width
+    int total_units;
+    int current_units;
+    bool finished;
+
+    int unitsFor(double percentage) const;
+    void resizeUnits(int new_total_units);
+    void applyProgress() override;
+    bool refresh() override;
+    double shownPercentage() const override;
+    void fillSnapshot(ProgressSnapshot& snapshot) override;
+    void redraw() override;
+};
+
+#endif // PROGRESS_INDICATOR_SEGMENT_BAR_HPP
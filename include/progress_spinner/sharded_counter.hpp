@@ -0,0 +1,162 @@
+#ifndef PROGRESS_INDICATOR_SHARDED_COUNTER_HPP
+#define PROGRESS_INDICATOR_SHARDED_COUNTER_HPP
+
+#include "work_progress.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Assumed size of a cache line; shards are padded to this size.
+ */
+constexpr size_t cache_line_size = 64;
+
+/**
+ * \brief Work counter split into one cache line per thread.
+ *
+ * Each thread counts into its own shard, so reporting progress never
+ * bounces a shared cache line between cores. done() sums the shards and is
+ * only called by the bar when it renders, through setSource().
+ */
+class ShardedCounter : public ProgressSource {
+public:
+    /**
+     * \brief One padded slot of the counter.
+     *
+     * Usually advanced by a single thread, so the relaxed fetch_add stays
+     * on a cache line that thread owns and is cheap. Sharing a shard, e.g.
+     * between two parallelFor() calls or with ShardedCounter::advance(),
+     * costs contention but never loses counts.
+     */
+    struct alignas(cache_line_size) Shard {
+        std::atomic<uint64_t> count{0};
+
+        void advance(uint64_t units = 1) {
+            count.fetch_add(units, std::memory_order_relaxed);
+        }
+    };
+
+    explicit ShardedCounter(size_t shards = 0);
+
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    void setTotal(uint64_t total) {
+        total_units.store(total, std::memory_order_relaxed);
+    }
+
+    void addTotal(uint64_t units) {
+        total_units.fetch_add(units, std::memory_order_relaxed);
+    }
+
+    void advance(uint64_t count = 1) {
+        shards[threadSlot() & mask].count.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    Shard& shard(size_t index) {
+        return shards[index & mask];
+    }
+
+    size_t shardCount() const {
+        return shards.size();
+    }
+
+    void reset();
+    uint64_t done() const override;
+    uint64_t total() const override {
+        return total_units.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<Shard> shards;
+    size_t mask;
+    alignas(cache_line_size) std::atomic<uint64_t> total_units;
+
+    static size_t threadSlot();
+};
+
+/**
+ * \brief Runs function(i) for every i in [begin, end) on several threads and
+ * counts each finished index in progress.
+ *
+ * Every worker advances its own shard, so progress reporting does not
+ * contend however many workers there are. Indices are handed out in chunks
+ * from a shared cursor. The total of progress is raised by end - begin. If
+ * function throws, the remaining chunks are skipped and the first exception
+ * is rethrown once all workers have stopped.
+ *
+ * Several parallelFor() calls may run on the same counter at once, also
+ * alongside ShardedCounter::advance(); they then share shards, which slows
+ * them down but keeps every count.
+ *
+ * \param begin First index.
+ * \param end One past the last index.
+ * \param progress Counter to report to, typically shown through a bar's
+ *                 setSource().
+ * \param function Called with each index, concurrently from the workers.
+ * \param threads Number of workers; 0 uses the hardware concurrency. At most
+ *                progress.shardCount() workers are started.
+ */
+template <typename Function>
+void parallelFor(uint64_t begin, uint64_t end, ShardedCounter& progress, Function function, size_t threads = 0) {
+    if (end <= begin) {
+        return;
+    }
+    uint64_t count = end - begin;
+    progress.addTotal(count);
+
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    threads = std::min(threads, progress.shardCount());
+    threads = static_cast<size_t>(std::min<uint64_t>(threads, count));
+    uint64_t chunk = std::max<uint64_t>(1, count / (threads * 16));
+
+    alignas(cache_line_size) std::atomic<uint64_t> cursor(begin);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](size_t index) {
+        ShardedCounter::Shard& shard = progress.shard(index);
+        try {
+            while (!failed.load(std::memory_order_relaxed)) {
+                uint64_t first = cursor.fetch_add(chunk, std::memory_order_relaxed);
+                if (first >= end) {
+                    break;
+                }
+                uint64_t last = std::min(end, first + chunk);
+                for (uint64_t i = first; i < last; ++i) {
+                    function(i);
+                    shard.advance();
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            failed.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+#endif // PROGRESS_INDICATOR_SHARDED_COUNTER_HPP
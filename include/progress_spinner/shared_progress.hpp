@@ -0,0 +1,99 @@
+#ifndef PROGRESS_INDICATOR_SHARED_PROGRESS_HPP
+#define PROGRESS_INDICATOR_SHARED_PROGRESS_HPP
+
+#include "sharded_counter.hpp"
+#include "work_progress.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * \brief Progress counters in memory shared between processes.
+ *
+ * The segment holds one slot per worker process: a done and a total counter
+ * on a cache line of their own, and a short label on the next one. Workers
+ * update their slot with plain atomic stores into the mapping, so reporting
+ * progress costs no system call; the parent reads the slots only when its
+ * bars render, through setSource().
+ *
+ * An anonymous segment is inherited by children created with fork(). A
+ * named segment, created with shm_open(), can also be attached to by
+ * processes started otherwise.
+ */
+class SharedProgress : public ProgressSource {
+public:
+    static constexpr size_t label_capacity = 56;
+
+    /**
+     * \brief Progress of one worker, laid out in the shared mapping.
+     *
+     * A slot must only be updated by one process, and one thread in it, at
+     * a time. The label is published with a sequence counter, so readers
+     * never see a half-written one.
+     */
+    struct alignas(cache_line_size) Slot {
+        std::atomic<uint64_t> done_units;
+        std::atomic<uint64_t> total_units;
+        alignas(cache_line_size) std::atomic<uint32_t> label_sequence;
+        std::atomic<uint32_t> label_size;
+        std::atomic<uint64_t> label_words[label_capacity / 8];
+
+        void advance(uint64_t count = 1) {
+            done_units.store(done_units.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+        }
+
+        void setDone(uint64_t done) {
+            done_units.store(done, std::memory_order_relaxed);
+        }
+
+        void setTotal(uint64_t total) {
+            total_units.store(total, std::memory_order_relaxed);
+        }
+
+        uint64_t done() const {
+            return done_units.load(std::memory_order_relaxed);
+        }
+
+        uint64_t total() const {
+            return total_units.load(std::memory_order_relaxed);
+        }
+
+        void setLabel(const std::string& label);
+        bool label(uint64_t& generation, std::string& text) const;
+    };
+
+    explicit SharedProgress(size_t slots, const std::string& name = std::string());
+    ~SharedProgress();
+
+    SharedProgress(const SharedProgress&) = delete;
+    SharedProgress& operator=(const SharedProgress&) = delete;
+
+    static std::unique_ptr<SharedProgress> attach(const std::string& name);
+
+    Slot& slot(size_t index);
+    std::shared_ptr<const ProgressSource> source(size_t index);
+
+    size_t slotCount() const {
+        return slot_count;
+    }
+
+    uint64_t done() const override;
+    uint64_t total() const override;
+
+private:
+    struct Header;
+
+    Header* header;
+    Slot* slots;
+    size_t slot_count;
+    size_t mapped_size;
+    std::string segment_name;
+    long owner_pid;
+
+    SharedProgress();
+    void map(int fd, size_t size);
+};
+
+#endif // PROGRESS_INDICATOR_SHARED_PROGRESS_HPP
@@ -0,0 +1,43 @@
+#ifndef PROGRESS_INDICATOR_STREAM_CAPTURE_HPP
+#define PROGRESS_INDICATOR_STREAM_CAPTURE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+/**
+ * \brief Takes over the buffer of a std::ostream and hands each complete
+ * line written to it to a callback.
+ *
+ * Installed by the constructor and restored by the destructor. Every thread
+ * collects its unfinished line in a buffer of its own, so lines written
+ * concurrently are never interleaved and writing takes no lock; the
+ * callback runs on the writing thread once per line.
+ */
+class StreamCapture : public std::streambuf {
+public:
+    using LineHandler = std::function<void(const std::string&)>;
+
+    StreamCapture(std::ostream& stream, LineHandler handler);
+    ~StreamCapture();
+
+    StreamCapture(const StreamCapture&) = delete;
+    StreamCapture& operator=(const StreamCapture&) = delete;
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    std::ostream& stream;
+    std::streambuf* original;
+    LineHandler handler;
+    uint64_t generation;
+
+    std::string& pendingLine();
+};
+
+#endif // PROGRESS_INDICATOR_STREAM_CAPTURE_HPP
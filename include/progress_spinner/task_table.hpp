@@ -0,0 +1,163 @@
+#ifndef PROGRESS_INDICATOR_TASK_TABLE_HPP
+#define PROGRESS_INDICATOR_TASK_TABLE_HPP
+
+#include "iconsole.hpp"
+#include "options.hpp"
+#include "render_scheduler.hpp"
+#include "screen_line.hpp"
+#include "sharded_counter.hpp"
+#include "work_progress.hpp"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \brief Look of the task rows of a TaskTable, shared by every task that
+ * uses it.
+ */
+struct TaskStyle {
+    int segments = 20;
+    std::string filled = "█";
+    std::string empty = "░";
+};
+
+/**
+ * \brief Tracks thousands of tasks, e.g. file transfers, and shows only a
+ * few of them.
+ *
+ * Tasks are not indicators: each one is an index into arrays of counters,
+ * totals, states, interned label ids and style ids, about 40 bytes per task
+ * in all. Updates are relaxed atomic operations on those arrays and never
+ * draw. The table is drawn by the RenderScheduler as one summary line over
+ * all tasks and a row for each of the top running tasks, either the most
+ * active or the slowest ones. Every frame rates a fixed number of tasks,
+ * taking turns, plus those started recently and those already shown, so
+ * the cost of a frame does not grow with the number of tasks.
+ *
+ * Every call that takes a TaskId needs an id returned by addTask() of this
+ * same table. The ids are not checked in release builds, since that would
+ * cost the updates a load of the task count; debug builds assert on them.
+ */
+class TaskTable : public Renderable {
+public:
+    enum class State : uint8_t { Queued, Running, Done, Failed };
+
+    using TaskId = uint32_t;
+    using StyleId = uint16_t;
+
+    explicit TaskTable(size_t capacity, const TaskTableOptions& options = TaskTableOptions());
+    ~TaskTable();
+
+    TaskTable(const TaskTable&) = delete;
+    TaskTable& operator=(const TaskTable&) = delete;
+
+    StyleId addStyle(const TaskStyle& style);
+    TaskId addTask(const std::string& label, uint64_t total = 0, StyleId style = 0);
+
+    void advance(TaskId task, uint64_t count = 1) {
+        assert(task < size());
+        done_units[task].fetch_add(count, std::memory_order_relaxed);
+        done_sum.advance(count);
+    }
+
+    void setDone(TaskId task, uint64_t done);
+    void setTotal(TaskId task, uint64_t total);
+    void startTask(TaskId task);
+    void finishTask(TaskId task);
+    void failTask(TaskId task);
+
+    uint64_t done(TaskId task) const {
+        assert(task < size());
+        return done_units[task].load(std::memory_order_relaxed);
+    }
+
+    uint64_t total(TaskId task) const {
+        assert(task < size());
+        return total_units[task].load(std::memory_order_relaxed);
+    }
+
+    State state(TaskId task) const {
+        assert(task < size());
+        return static_cast<State>(states[task].load(std::memory_order_relaxed));
+    }
+
+    size_t size() const {
+        return task_count.load(std::memory_order_acquire);
+    }
+
+    size_t count(State state) const {
+        return state_counts[static_cast<size_t>(state)].load(std::memory_order_relaxed);
+    }
+
+    void start();
+    void stop();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const size_t capacity;
+    const size_t top_tasks;
+    const option::TaskOrder::Order task_order;
+    const int refresh_rate_hz;
+    const int log_interval_sec;
+
+    // One entry per task; written by the tasks' owners
+    std::unique_ptr<std::atomic<uint64_t>[]> done_units;
+    std::unique_ptr<std::atomic<uint64_t>[]> total_units;
+    std::unique_ptr<std::atomic<uint8_t>[]> states;
+    // One entry per task; written once by addTask()
+    std::unique_ptr<uint32_t[]> label_ids;
+    std::unique_ptr<StyleId[]> style_ids;
+    // One entry per task; renderer only
+    std::unique_ptr<uint64_t[]> seen_done;
+    std::unique_ptr<uint32_t[]> seen_ms;
+    std::unique_ptr<float[]> activity;
+    std::atomic<uint32_t> task_count;
+    // Ids of the tasks started last, so new tasks get a row right away
+    std::unique_ptr<std::atomic<uint32_t>[]> recent_starts;
+    std::atomic<uint32_t> recent_cursor;
+
+    ShardedCounter done_sum;
+    std::atomic<uint64_t> total_sum;
+    std::atomic<size_t> state_counts[4];
+
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> label_index;
+    std::deque<std::string> labels;
+    // Display width of each label, measured once when it is added
+    std::deque<size_t> label_widths;
+    std::vector<std::shared_ptr<const TaskStyle>> styles;
+
+    Console console;
+    Clock::time_point started_at;
+    Clock::time_point last_log;
+    ThroughputEstimator throughput;
+    size_t scan_cursor;
+    std::vector<TaskId> candidates;
+    std::vector<TaskId> shown;
+    std::vector<std::string> lines;
+    std::vector<ScreenLine> screen_lines;
+    std::string frame_buffer;
+    size_t drawn_rows;
+    size_t previous_drawn_rows;
+    bool running;
+
+    void setState(TaskId task, State state);
+    void renderFrame(std::string& frame) override;
+    void frameDropped() override;
+    void pickShown(Clock::time_point now);
+    void observe(TaskId task, uint32_t now_ms);
+    void addCandidate(TaskId task, uint32_t now_ms);
+    void composeSummary(std::string& line);
+    void composeTask(TaskId task, size_t label_width, std::string& line);
+    void composeBlock(std::string& frame);
+};
+
+#endif // PROGRESS_INDICATOR_TASK_TABLE_HPP
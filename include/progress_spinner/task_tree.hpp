@@ -0,0 +1,65 @@
+#ifndef PROGRESS_INDICATOR_TASK_TREE_HPP
+#define PROGRESS_INDICATOR_TASK_TREE_HPP
+
+#include "work_progress.hpp"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * \brief Node of a tree of weighted tasks, e.g. job, phases, files, chunks.
+ *
+ * Leaves count their own work units; updating one is a single relaxed
+ * atomic operation and never touches its ancestors. Inner nodes hold no
+ * progress of their own: aggregate() combines the children, weighted, in a
+ * single walk of the subtree when it is called, which for a node shown
+ * through a bar's setSource() means once per frame.
+ *
+ * Children can be added from any thread while the tree is being rendered.
+ * They are never removed and are owned by their parent, so the tree must
+ * outlive every bar that shows it.
+ */
+class TaskNode : public ProgressSource {
+public:
+    explicit TaskNode(double weight = 1.0, uint64_t total = 0);
+    ~TaskNode();
+
+    TaskNode(const TaskNode&) = delete;
+    TaskNode& operator=(const TaskNode&) = delete;
+
+    TaskNode& addChild(double weight = 1.0, uint64_t total = 0);
+
+    void setTotal(uint64_t total) {
+        total_units.store(total, std::memory_order_relaxed);
+    }
+
+    void advance(uint64_t count = 1) {
+        done_units.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void setDone(uint64_t done) {
+        done_units.store(done, std::memory_order_relaxed);
+    }
+
+    void complete() {
+        completed.store(true, std::memory_order_relaxed);
+    }
+
+    double weight() const {
+        return node_weight;
+    }
+
+    uint64_t done() const override;
+    uint64_t total() const override;
+    double fraction() const override;
+    ProgressAggregate aggregate() const override;
+
+private:
+    const double node_weight;
+    std::atomic<uint64_t> done_units;
+    std::atomic<uint64_t> total_units;
+    std::atomic<bool> completed;
+    std::atomic<TaskNode*> first_child;
+    TaskNode* next_sibling;
+};
+
+#endif // PROGRESS_INDICATOR_TASK_TREE_HPP
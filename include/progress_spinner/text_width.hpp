@@ -0,0 +1,203 @@
+#ifndef PROGRESS_INDICATOR_TEXT_WIDTH_HPP
+#define PROGRESS_INDICATOR_TEXT_WIDTH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace text_width_detail {
+
+struct CodePointRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Combining marks, zero-width spaces and joiners, and variation selectors
+constexpr CodePointRange zero_width_ranges[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x0610, 0x061A},
+    {0x064B, 0x065F}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A}, {0x200B, 0x200F},
+    {0x20D0, 0x20FF}, {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xE0100, 0xE01EF},
+};
+
+// East Asian wide and fullwidth characters, and emoji presented as wide, as
+// in East_Asian_Width W and F of Unicode 14. Symbols such as U+2713 check
+// mark have text presentation and take one cell, even in U+2600 to U+27BF.
+constexpr CodePointRange wide_ranges[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0},
+    {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F},
+    {0x2693, 0x2693}, {0x26A1, 0x26A1}, {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5},
+    {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B}, {0x2728, 0x2728},
+    {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+    {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55},
+    {0x2E80, 0x303E}, {0x3041, 0x4DBF}, {0x4E00, 0xA4CF}, {0xA960, 0xA97C}, {0xAC00, 0xD7A3},
+    {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6B}, {0xFF00, 0xFF60}, {0xFFE0, 0xFFE6},
+    {0x16FE0, 0x16FE3}, {0x16FF0, 0x18D08}, {0x1AFF0, 0x1B2FB}, {0x1F004, 0x1F004},
+    {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A}, {0x1F200, 0x1F64F},
+    {0x1F680, 0x1F6FF}, {0x1F7E0, 0x1F7F0}, {0x1F900, 0x1F9FF}, {0x1FA70, 0x1FAF6},
+    {0x20000, 0x3FFFD},
+};
+
+template <size_t N>
+constexpr bool inRanges(const CodePointRange (&ranges)[N], uint32_t code_point) {
+    size_t low = 0;
+    size_t high = N;
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        if (code_point > ranges[middle].last) {
+            low = middle + 1;
+        } else if (code_point < ranges[middle].first) {
+            high = middle;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * \brief Number of console cells taken by a non-ASCII code point.
+ */
+constexpr size_t codePointWidth(uint32_t code_point) {
+    if (code_point < 0xA0) {
+        return 0;  // C1 control characters
+    }
+    if (inRanges(zero_width_ranges, code_point)) {
+        return 0;
+    }
+    return inRanges(wide_ranges, code_point) ? 2 : 1;
+}
+
+/**
+ * \brief Decodes one UTF-8 sequence starting at a non-ASCII byte.
+ *
+ * \param text Start of the sequence.
+ * \param size Bytes available from text.
+ * \param code_point Receives the decoded code point.
+ * \return Length of the sequence, or 0 if it is malformed, overlong,
+ *         truncated or encodes a surrogate or a value beyond U+10FFFF.
+ */
+constexpr size_t decodeUtf8(const char* text, size_t size, uint32_t& code_point) {
+    unsigned char lead = static_cast<unsigned char>(text[0]);
+    size_t length = 0;
+    uint32_t minimum = 0;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        minimum = 0x80;
+        code_point = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        minimum = 0x800;
+        code_point = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        minimum = 0x10000;
+        code_point = lead & 0x07;
+    } else {
+        return 0;
+    }
+    if (length > size) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        unsigned char byte = static_cast<unsigned char>(text[i]);
+        if ((byte & 0xC0) != 0x80) {
+            return 0;
+        }
+        code_point = (code_point << 6) | (byte & 0x3F);
+    }
+    if (code_point < minimum || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+} // namespace text_width_detail
+
+size_t displayWidth(const char* text, size_t size);
+bool isValidUtf8(const char* text, size_t size);
+std::string ellipsize(const std::string& text, size_t width);
+size_t appendEllipsized(std::string& line, const std::string& text, size_t text_width, size_t width);
+void ellipsizeInPlace(std::string& text, size_t width);
+
+inline size_t displayWidth(const std::string& text) {
+    return displayWidth(text.data(), text.size());
+}
+
+inline bool isValidUtf8(const std::string& text) {
+    return isValidUtf8(text.data(), text.size());
+}
+
+/**
+ * \brief Length of a null-terminated string, usable at compile time.
+ */
+constexpr size_t staticLength(const char* text) {
+    size_t size = 0;
+    while (text[size] != '\0') {
+        ++size;
+    }
+    return size;
+}
+
+/**
+ * \brief Compile-time counterpart of isValidUtf8() for string literals.
+ */
+constexpr bool staticIsValidUtf8(const char* text) {
+    size_t size = staticLength(text);
+    size_t i = 0;
+    while (i < size) {
+        if (static_cast<unsigned char>(text[i]) < 0x80) {
+            ++i;
+            continue;
+        }
+        uint32_t code_point = 0;
+        size_t length = text_width_detail::decodeUtf8(text + i, size - i, code_point);
+        if (length == 0) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+/**
+ * \brief Compile-time counterpart of displayWidth() for string literals.
+ */
+constexpr size_t staticDisplayWidth(const char* text) {
+    size_t size = staticLength(text);
+    size_t width = 0;
+    size_t i = 0;
+    while (i < size) {
+        if (static_cast<unsigned char>(text[i]) < 0x80) {
+            ++width;
+            ++i;
+            continue;
+        }
+        uint32_t code_point = 0;
+        size_t length = text_width_detail::decodeUtf8(text + i, size - i, code_point);
+        if (length == 0) {
+            ++width;
+            ++i;
+        } else {
+            width += text_width_detail::codePointWidth(code_point);
+            i += length;
+        }
+    }
+    return width;
+}
+
+/**
+ * \brief A validated piece of UTF-8 text together with its console width.
+ *
+ * Glyph sets are converted into Glyphs once, so that frames can copy bytes
+ * and add up widths without decoding or measuring the text again.
+ */
+struct Glyph {
+    std::string bytes;
+    size_t width;
+
+    explicit Glyph(const std::string& text = "");
+};
+
+#endif // PROGRESS_INDICATOR_TEXT_WIDTH_HPP
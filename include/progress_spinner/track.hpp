@@ -0,0 +1,243 @@
+#ifndef PROGRESS_INDICATOR_TRACK_HPP
+#define PROGRESS_INDICATOR_TRACK_HPP
+
+#include "options.hpp"
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+/**
+ * \brief Counts items locally and publishes them to a bar in batches.
+ *
+ * The clock is only read every stride items. The stride doubles while items
+ * arrive faster than the publish interval and halves when they are slower,
+ * so a fast loop pays one increment and one compare per item while a slow
+ * loop still publishes every item on time.
+ */
+template <typename Bar>
+class TrackCounter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TrackCounter(Bar& bar, const TrackOptions& options)
+        : bar(bar),
+          pending(0),
+          stride(1),
+          next_check(1),
+          max_batch(static_cast<uint64_t>(options.batch_items)),
+          interval(std::chrono::milliseconds(options.publish_interval_ms)),
+          last_publish(Clock::now()) {}
+
+    ~TrackCounter() {
+        publish();
+    }
+
+    TrackCounter(const TrackCounter&) = delete;
+    TrackCounter& operator=(const TrackCounter&) = delete;
+
+    void count() {
+        if (++pending >= next_check) {
+            checkClock();
+        }
+    }
+
+    void publish();
+
+private:
+    Bar& bar;
+    uint64_t pending;
+    uint64_t stride;
+    uint64_t next_check;
+    uint64_t max_batch;
+    Clock::duration interval;
+    Clock::time_point last_publish;
+
+    void checkClock();
+};
+
+/**
+ * \brief Hands the items counted so far to the bar.
+ */
+template <typename Bar>
+void TrackCounter<Bar>::publish() {
+    if (pending > 0) {
+        bar.advance(pending);
+        pending = 0;
+    }
+    next_check = stride;
+}
+
+/**
+ * \brief Publishes when the batch is full or the interval has passed, and
+ * adapts the stride to the item rate.
+ */
+template <typename Bar>
+void TrackCounter<Bar>::checkClock() {
+    Clock::time_point now = Clock::now();
+    Clock::duration elapsed = now - last_publish;
+    if (elapsed >= interval || pending >= max_batch) {
+        if (elapsed >= 2 * interval && stride > 1) {
+            stride /= 2;
+        }
+        last_publish = now;
+        publish();
+        return;
+    }
+    if (stride < max_batch) {
+        stride *= 2;
+    }
+    next_check = pending + stride < max_batch ? pending + stride : max_batch;
+}
+
+namespace track_detail {
+
+template <typename Iterator>
+struct IteratorPair {
+    Iterator first;
+    Iterator last;
+
+    Iterator begin() const {
+        return first;
+    }
+    Iterator end() const {
+        return last;
+    }
+};
+
+/**
+ * \brief Number of items in range, or 0 if it cannot be known up front.
+ *
+ * Uses the range's size() when it has one and the iterator distance for
+ * other forward ranges; input ranges can only be walked once.
+ */
+template <typename Range>
+auto rangeSize(Range& range, int) -> decltype(static_cast<uint64_t>(std::size(range))) {
+    return static_cast<uint64_t>(std::size(range));
+}
+
+template <typename Range>
+uint64_t rangeSize(Range& range, long) {
+    using Iterator = decltype(std::begin(range));
+    using Category = typename std::iterator_traits<Iterator>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+        return static_cast<uint64_t>(std::distance(std::begin(range), std::end(range)));
+    } else {
+        return 0;
+    }
+}
+
+} // namespace track_detail
+
+/**
+ * \brief A range whose iteration advances a progress bar.
+ *
+ * Created by track(). Borrows lvalue ranges and takes ownership of
+ * temporaries, so it can be used directly in a range-based for loop. Items
+ * still counted locally are published when iteration reaches the end and
+ * when the range is destroyed, e.g. after a break.
+ */
+template <typename Range, typename Bar>
+class TrackedRange {
+    using BaseIterator = decltype(std::begin(std::declval<Range&>()));
+
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = typename std::iterator_traits<BaseIterator>::value_type;
+        using difference_type = typename std::iterator_traits<BaseIterator>::difference_type;
+        using reference = decltype(*std::declval<BaseIterator&>());
+        using pointer = void;
+
+        iterator(BaseIterator base, TrackCounter<Bar>* counter) : base(base), counter(counter) {}
+
+        reference operator*() const {
+            return *base;
+        }
+
+        iterator& operator++() {
+            ++base;
+            counter->count();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(const iterator& other) const {
+            if (base == other.base) {
+                counter->publish();
+                return true;
+            }
+            return false;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        BaseIterator base;
+        TrackCounter<Bar>* counter;
+    };
+
+    TrackedRange(Range&& range, Bar& bar, const TrackOptions& options)
+        : range(std::forward<Range>(range)), counter(bar, options) {
+        uint64_t size = track_detail::rangeSize(this->range, 0);
+        if (size > 0) {
+            bar.setTotal(size);
+        }
+    }
+
+    TrackedRange(const TrackedRange&) = delete;
+    TrackedRange& operator=(const TrackedRange&) = delete;
+
+    iterator begin() {
+        return iterator(std::begin(range), &counter);
+    }
+
+    iterator end() {
+        return iterator(std::end(range), &counter);
+    }
+
+private:
+    Range range;
+    TrackCounter<Bar> counter;
+};
+
+/**
+ * \brief Iterates over range and advances bar by one unit per item.
+ *
+ * For sized and forward ranges the bar's total is set to the number of
+ * items; for input ranges set it beforehand with bar.setTotal(). Works with
+ * any bar that has setTotal() and advance(), e.g. HProgressBar.
+ *
+ * \code
+ * for (const Record& record : track(records, bar)) {
+ *     process(record);
+ * }
+ * \endcode
+ *
+ * \param range The range to iterate over; temporaries are kept alive.
+ * \param bar The bar to advance. Must outlive the returned range.
+ * \param options How often counted items are published to the bar.
+ */
+template <typename Range, typename Bar>
+TrackedRange<Range, Bar> track(Range&& range, Bar& bar, const TrackOptions& options = TrackOptions()) {
+    return TrackedRange<Range, Bar>(std::forward<Range>(range), bar, options);
+}
+
+/**
+ * \brief Iterates over [first, last) and advances bar by one unit per item.
+ */
+template <typename Iterator, typename Bar>
+TrackedRange<track_detail::IteratorPair<Iterator>, Bar> track(Iterator first, Iterator last, Bar& bar,
+                                                             const TrackOptions& options = TrackOptions()) {
+    return TrackedRange<track_detail::IteratorPair<Iterator>, Bar>(
+        track_detail::IteratorPair<Iterator>{first, last}, bar, options);
+}
+
+#endif // PROGRESS_INDICATOR_TRACK_HPP
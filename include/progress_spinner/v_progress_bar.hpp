@@ -1,16 +1,16 @@
 #ifndef PROGRESS_INDICATOR_V_PROGRESS_BAR_HPP
 #define PROGRESS_INDICATOR_V_PROGRESS_BAR_HPP
 
-#include "progress_indicator.hpp"
 #include "options.hpp"
+#include "work_progress_indicator.hpp"
 
-class VProgressBar : public ProgressIndicator {
+class VProgressBar : public WorkProgressIndicator {
 public:
     VProgressBar(const VProgressBarOptions& options = VProgressBarOptions());
+    ~VProgressBar();
 
     void start() override;
     void stop() override;
-    void updateProgress(double new_percentage);
     void updateText(const std::string& new_text) override;
 
     double getTick() const {
@@ -23,8 +23,19 @@ private:
     double tick;
     bool completed;
     bool displayed_completed_label;
+    size_t drawn_frame;
+    size_t glyph_width;
 
-    void redraw();
+    size_t frameIndex(double percentage) const;
+    void applyProgress() override;
+    void composeRefreshed(std::string& frame) override;
+    void discardFrame() override;
+    bool refresh() override;
+    double shownPercentage() const override;
+    void composeLine(std::string& line) override;
+    void fillSnapshot(ProgressSnapshot& snapshot) override;
+    void finish(std::string& frame);
+    void redraw() override;
 };
 
 #endif // PROGRESS_INDICATOR_V_PROGRESS_BAR_HPP
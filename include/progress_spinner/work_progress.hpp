@@ -0,0 +1,150 @@
+#ifndef PROGRESS_INDICATOR_WORK_PROGRESS_HPP
+#define PROGRESS_INDICATOR_WORK_PROGRESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * \brief Done and total units of a source and its completed share, read
+ * together.
+ */
+struct ProgressAggregate {
+    uint64_t done;
+    uint64_t total;
+    double fraction;
+};
+
+/**
+ * \brief Read-only view of work progress that bars poll when they render.
+ *
+ * A total of 0 means no total has been set.
+ */
+class ProgressSource {
+public:
+    virtual ~ProgressSource() = default;
+
+    virtual uint64_t done() const = 0;
+    virtual uint64_t total() const = 0;
+
+    /**
+     * \brief Completed share of the work, between 0 and 1.
+     *
+     * Defaults to done() / total(); sources that weight their parts
+     * differently override it.
+     */
+    virtual double fraction() const {
+        uint64_t units = total();
+        if (units == 0) {
+            return 0.0;
+        }
+        double share = static_cast<double>(done()) / static_cast<double>(units);
+        return share < 1.0 ? share : 1.0;
+    }
+
+    /**
+     * \brief Reads done(), total() and fraction() at once.
+     *
+     * Bars call this once per frame. Sources that compute the three from
+     * the same parts, like TaskNode, override it to do so in one pass.
+     */
+    virtual ProgressAggregate aggregate() const {
+        ProgressAggregate progress;
+        progress.done = done();
+        progress.total = total();
+        progress.fraction = fraction();
+        return progress;
+    }
+
+    /**
+     * \brief Label published by the source, for sources that carry one.
+     *
+     * Bars showing the source adopt the label when it changes.
+     *
+     * \param generation The generation the caller has seen, 0 initially;
+     *                   updated when a newer label is returned.
+     * \param text Receives the label.
+     * \return true if text was set to a newer label.
+     */
+    virtual bool label(uint64_t& generation, std::string& text) const {
+        (void)generation;
+        (void)text;
+        return false;
+    }
+
+protected:
+    ProgressSource() = default;
+};
+
+/**
+ * \brief Counts completed work units against a total.
+ *
+ * All updates are single relaxed atomic operations, so producers on any
+ * thread can report progress without locking.
+ */
+class WorkCounter : public ProgressSource {
+public:
+    WorkCounter();
+
+    void setTotal(uint64_t total) {
+        total_units.store(total, std::memory_order_relaxed);
+    }
+
+    void advance(uint64_t count) {
+        done_units.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void setDone(uint64_t done) {
+        done_units.store(done, std::memory_order_relaxed);
+    }
+
+    uint64_t done() const override {
+        return done_units.load(std::memory_order_relaxed);
+    }
+
+    uint64_t total() const override {
+        return total_units.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> done_units;
+    std::atomic<uint64_t> total_units;
+};
+
+/**
+ * \brief Render-side estimate of throughput and time to completion.
+ *
+ * Samples the done count at most every sample interval and smooths the
+ * measured rate with an exponentially weighted moving average, so that the
+ * rate and ETA stay readable even when work arrives in bursts.
+ */
+class ThroughputEstimator {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ThroughputEstimator();
+
+    bool sample(uint64_t done, Clock::time_point now);
+    void reset();
+
+    double rate() const {
+        return items_per_second;
+    }
+
+    double etaSeconds(uint64_t done, uint64_t total) const;
+
+    void appendStats(std::string& line, uint64_t done, uint64_t total) const;
+
+private:
+    Clock::time_point last_time;
+    uint64_t last_done;
+    double items_per_second;
+    bool has_sample;
+    bool has_rate;
+};
+
+void appendUnsigned(std::string& line, uint64_t value);
+void appendQuantity(std::string& line, double value);
+
+#endif // PROGRESS_INDICATOR_WORK_PROGRESS_HPP
@@ -0,0 +1,80 @@
+#ifndef PROGRESS_INDICATOR_WORK_PROGRESS_INDICATOR_HPP
+#define PROGRESS_INDICATOR_WORK_PROGRESS_INDICATOR_HPP
+
+#include "progress_indicator.hpp"
+#include "work_progress.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * \brief Base of the bars that show a percentage or counted work units.
+ *
+ * Holds what HProgressBar, BasicHProgressBar and VProgressBar share: the
+ * percentage and the work counter written by producers, the optional
+ * external source, the throughput estimate, and the choice between drawing
+ * on every update (immediate mode) and leaving it to the renderer (deferred
+ * mode, with a refresh rate or inside a MultiProgress). While counting work
+ * units, a bar in immediate mode is drawn by the renderer too, so producers
+ * never draw. The bars only decide what a frame looks like.
+ */
+class WorkProgressIndicator : public ProgressIndicator {
+public:
+    void updateProgress(double new_percentage);
+    void updateText(const std::string& new_text) override;
+
+    void setTotal(uint64_t total);
+    void advance(uint64_t count = 1);
+    void setDone(uint64_t done);
+    void setSource(std::shared_ptr<const ProgressSource> source);
+
+protected:
+    WorkProgressIndicator(const std::string& progress_label, const std::string& completed_label,
+                          int refresh_rate_hz);
+
+    const ProgressSource* source;
+    // What source showed when last read, once per frame
+    ProgressAggregate source_progress;
+    ThroughputEstimator throughput;
+    std::string stats_text;
+    size_t stats_reserve;
+
+    bool deferred() const {
+        return refresh_rate_hz > 0 || managed || following_work.load(std::memory_order_relaxed);
+    }
+
+    void readSource();
+    double pendingPercentage() const;
+    void resetWork();
+    void startRendering();
+    bool sampleThroughput();
+    void composeStats();
+    void fillSnapshot(ProgressSnapshot& snapshot) override;
+
+    /**
+     * \brief Shows the latest stored percentage in immediate mode.
+     *
+     * \note The caller must hold the mutex.
+     */
+    virtual void applyProgress() = 0;
+
+    /**
+     * \brief Draws the bar from the calling thread in immediate mode.
+     *
+     * \note The caller must hold the mutex.
+     */
+    virtual void redraw() = 0;
+
+private:
+    int refresh_rate_hz;
+    std::atomic<double> pending_percentage;
+    WorkCounter work;
+    std::shared_ptr<const ProgressSource> external_source;
+    std::atomic<bool> following_work;
+
+    void followWork(bool follow);
+    void drawChanges();
+};
+
+#endif // PROGRESS_INDICATOR_WORK_PROGRESS_INDICATOR_HPP
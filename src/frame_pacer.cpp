@@ -0,0 +1,92 @@
+#include "progress_spinner/frame_pacer.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+constexpr std::chrono::microseconds FramePacer::slow_write;
+constexpr size_t FramePacer::backlog_bytes;
+constexpr double FramePacer::max_slowdown;
+constexpr uint32_t FramePacer::backlog_check_writes;
+
+/**
+ * \brief Constructor for FramePacer.
+ *
+ * Starts without any slowdown and with a minimum frame rate of 2 Hz.
+ */
+FramePacer::FramePacer() : factor(1.0), min_rate_hz(2.0), unmeasured_writes(0) {}
+
+/**
+ * \brief Checks whether the sink's queue should be measured after a write.
+ *
+ * Always after a slow write and while slowed down, where the queue decides
+ * when to speed up again. Otherwise only every backlog_check_writes writes,
+ * which still catches a queue that fills up without blocking the writes.
+ * recordWrite() is then given 0 pending bytes.
+ *
+ * \param took How long the write to the sink took.
+ */
+bool FramePacer::backlogDue(Clock::duration took) {
+    if (took >= slow_write || slowdown() > 1.0) {
+        return true;
+    }
+    return unmeasured_writes.fetch_add(1, std::memory_order_relaxed) % backlog_check_writes == 0;
+}
+
+/**
+ * \brief Adjusts the slowdown after a frame was written.
+ *
+ * Called by every writer, so it only uses atomics. Concurrent writers may
+ * overwrite each other's adjustment, which only delays the next one.
+ *
+ * \param took How long the write to the sink took.
+ * \param pending_bytes Bytes the sink still had queued after the write.
+ */
+void FramePacer::recordWrite(Clock::duration took, size_t pending_bytes) {
+    double current = factor.load(std::memory_order_relaxed);
+    double next;
+    if (took >= slow_write || pending_bytes >= backlog_bytes) {
+        next = std::min(current * 2.0, max_slowdown);
+    } else {
+        next = std::max(current / 2.0, 1.0);
+    }
+    if (next != current) {
+        factor.store(next, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief Returns the interval to use instead of interval right now.
+ *
+ * The interval is stretched by the slowdown, but not beyond the interval of
+ * the minimum frame rate. Intervals that are already longer are kept.
+ *
+ * \param interval The configured interval between two frames.
+ */
+std::chrono::microseconds FramePacer::pace(std::chrono::microseconds interval) const {
+    double slowed = static_cast<double>(interval.count()) * slowdown();
+    double longest = std::max(1e6 / minRateHz(), static_cast<double>(interval.count()));
+    return std::chrono::microseconds(static_cast<int64_t>(std::min(slowed, longest)));
+}
+
+/**
+ * \brief Frame rate an indicator with the given interval runs at right now.
+ *
+ * \param interval The configured interval between two frames.
+ * \return The effective rate in Hz, or 0 for a zero interval.
+ */
+double FramePacer::rateHz(std::chrono::microseconds interval) const {
+    std::chrono::microseconds paced = pace(interval);
+    return paced.count() > 0 ? 1e6 / static_cast<double>(paced.count()) : 0.0;
+}
+
+/**
+ * \brief Sets the frame rate below which the output is never slowed down.
+ *
+ * \param hz The minimum rate; must be positive.
+ */
+void FramePacer::setMinRateHz(double hz) {
+    if (!(hz > 0.0)) {
+        throw std::invalid_argument("FramePacer: minimum rate must be positive, got " + std::to_string(hz));
+    }
+    min_rate_hz.store(hz, std::memory_order_relaxed);
+}
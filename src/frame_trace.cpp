@@ -0,0 +1,190 @@
+#include "progress_spinner/frame_trace.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+const char trace_magic[8] = {'P', 'I', 'T', 'R', 'A', 'C', 'E', '1'};
+
+// Far more than any frame; guards against allocating for a corrupt size
+const uint64_t max_frame_size = 64 * 1024 * 1024;
+
+void appendVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+} // namespace
+
+/**
+ * \brief Constructor for RecordingSink; creates the trace file.
+ *
+ * \param target Sink that receives the writes.
+ * \param path Trace file to create; an existing file is replaced.
+ * \throws std::system_error if the file cannot be created.
+ */
+RecordingSink::RecordingSink(std::shared_ptr<OutputSink> target, const std::string& path)
+    : target(std::move(target)), file(std::fopen(path.c_str(), "wb")), last_record(Clock::now()), recorded(0) {
+    if (file == nullptr) {
+        throw std::system_error(errno, std::generic_category(), "RecordingSink: cannot create " + path);
+    }
+    record.assign(trace_magic, sizeof(trace_magic));
+    appendVarint(record, this->target->isTerminal() ? 1 : 0);
+    appendVarint(record, this->target->columns());
+    std::fwrite(record.data(), 1, record.size(), file);
+    record.reserve(4096);
+}
+
+/**
+ * \brief Destructor for RecordingSink; completes the trace file.
+ */
+RecordingSink::~RecordingSink() {
+    std::fclose(file);
+}
+
+/**
+ * \brief Writes data to the target; recorded as from no particular source.
+ */
+bool RecordingSink::write(const char* data, size_t size) {
+    FrameSpan span{0, size};
+    return writeFrame(data, size, &span, 1);
+}
+
+/**
+ * \brief Writes data to the target and records it if it was delivered.
+ *
+ * Frames the target dropped never reached the screen and are not recorded.
+ * Writes from different threads are recorded in the order they reach the
+ * target.
+ *
+ * \return false if the target dropped the frame.
+ */
+bool RecordingSink::writeFrame(const char* data, size_t size, const FrameSpan* spans, size_t span_count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!target->writeFrame(data, size, spans, span_count)) {
+        return false;
+    }
+    Clock::time_point now = Clock::now();
+    record.clear();
+    appendVarint(record, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_record).count()));
+    appendVarint(record, span_count);
+    for (size_t i = 0; i < span_count; ++i) {
+        appendVarint(record, spans[i].source_id);
+        appendVarint(record, spans[i].size);
+    }
+    record.append(data, size);
+    std::fwrite(record.data(), 1, record.size(), file);
+    last_record = now;
+    ++recorded;
+    return true;
+}
+
+/**
+ * \brief Waits for the target and writes the buffered records to the file.
+ */
+void RecordingSink::flush() {
+    target->flush();
+    std::lock_guard<std::mutex> lock(mutex);
+    std::fflush(file);
+}
+
+/**
+ * \brief Returns the number of frames recorded so far.
+ */
+uint64_t RecordingSink::recordedFrames() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recorded;
+}
+
+/**
+ * \brief Constructor for TraceReader; opens the trace and reads its header.
+ *
+ * \param path Trace file written by a RecordingSink.
+ * \throws std::system_error if the file cannot be opened, and
+ *         std::runtime_error if it is not a frame trace.
+ */
+TraceReader::TraceReader(const std::string& path)
+    : file(std::fopen(path.c_str(), "rb")), terminal(false), terminal_columns(0), time_ns(0) {
+    if (file == nullptr) {
+        throw std::system_error(errno, std::generic_category(), "TraceReader: cannot open " + path);
+    }
+    char magic[sizeof(trace_magic)];
+    uint64_t terminal_flag = 0;
+    uint64_t columns = 0;
+    if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        std::memcmp(magic, trace_magic, sizeof(magic)) != 0 || !readVarint(terminal_flag) || !readVarint(columns)) {
+        std::fclose(file);
+        throw std::runtime_error("TraceReader: " + path + " is not a frame trace");
+    }
+    terminal = terminal_flag != 0;
+    terminal_columns = static_cast<size_t>(columns);
+}
+
+TraceReader::~TraceReader() {
+    std::fclose(file);
+}
+
+/**
+ * \brief Reads the next frame.
+ *
+ * \param frame Receives the frame.
+ * \return false at the end of the trace.
+ * \throws std::runtime_error if the trace ends in the middle of a frame,
+ *         e.g. because the recording process was killed.
+ */
+bool TraceReader::next(TraceFrame& frame) {
+    uint64_t delta = 0;
+    if (!readVarint(delta)) {
+        return false;
+    }
+    uint64_t span_count = 0;
+    if (!readVarint(span_count)) {
+        throw std::runtime_error("TraceReader: truncated frame");
+    }
+    frame.spans.clear();
+    uint64_t size = 0;
+    for (uint64_t i = 0; i < span_count; ++i) {
+        uint64_t source_id = 0;
+        uint64_t span_size = 0;
+        if (!readVarint(source_id) || !readVarint(span_size)) {
+            throw std::runtime_error("TraceReader: truncated frame");
+        }
+        frame.spans.push_back(FrameSpan{source_id, static_cast<size_t>(span_size)});
+        size += span_size;
+        if (size > max_frame_size) {
+            throw std::runtime_error("TraceReader: corrupt frame of " + std::to_string(size) + " bytes");
+        }
+    }
+    frame.bytes.resize(static_cast<size_t>(size));
+    if (size > 0 && std::fread(&frame.bytes[0], 1, frame.bytes.size(), file) != frame.bytes.size()) {
+        throw std::runtime_error("TraceReader: truncated frame");
+    }
+    time_ns += delta;
+    frame.time_ns = time_ns;
+    return true;
+}
+
+/**
+ * \brief Reads one varint.
+ *
+ * \return false at the end of the file or on a malformed varint.
+ */
+bool TraceReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = std::fgetc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,77 +1,154 @@
 #include "progress_spinner/h_progress_bar.hpp"
-#include <cmath>
-#include <iostream>
-#include <mutex>
+#include <algorithm>
 
 HProgressBar::HProgressBar(const HProgressBarOptions& bar_options)
-    : ProgressIndicator(bar_options.progress_label, bar_options.completed_label),
+    : SegmentBar(bar_options.progress_label, bar_options.completed_label, bar_options.refresh_rate_hz,
+                 bar_options.total_segments * (static_cast<int>(bar_options.partial_chars.size()) + 1)),
         total_segments(bar_options.total_segments),
-        progress_chars(bar_options.progress_chars),
-        bracket_chars(bar_options.bracket_chars),
-        current_segments(0),
+        segments(bar_options.total_segments),
+        steps_per_segment(static_cast<int>(bar_options.partial_chars.size()) + 1),
         // options(&options) {
-        use_brackets_flag_(bar_options.has_brackets()) {
+        use_brackets_flag_(bar_options.has_brackets()),
+        empty_glyph(bar_options.progress_chars[0]),
+        filled_glyph(bar_options.progress_chars[1]),
+        open_bracket(bar_options.bracket_chars[0]),
+        close_bracket(bar_options.bracket_chars[1]),
+        partial_glyphs(bar_options.partial_chars.begin(), bar_options.partial_chars.end()),
+        show_stats(true),
+        layout_columns(0),
+        layout_generation(0),
+        layout_stats_reserve(0) {
     if (total_segments <= 0) {
         throw std::invalid_argument("Total segments must be greater than 0.");
     }
+    log_line = LogLine(bar_options.log_interval_sec, bar_options.log_percent_step);
+
+    // Pre-render a full bar of each segment kind; frames copy a slice of each
+    filled_run.reserve(static_cast<size_t>(total_segments) * filled_glyph.bytes.size());
+    empty_run.reserve(static_cast<size_t>(total_segments) * empty_glyph.bytes.size());
+    for (int i = 0; i < total_segments; ++i) {
+        filled_run += filled_glyph.bytes;
+        empty_run += empty_glyph.bytes;
+    }
 
     showCursor(false);
 }
 
-void HProgressBar::start() {
-    updateProgress(0);
+/**
+ * \brief Destructor for HProgressBar.
+ *
+ * Leaves the list of live indicators and stops the renderer, if one is
+ * running, before the bar state goes away.
+ */
+HProgressBar::~HProgressBar() {
+    unregisterIndicator();
+    stopRenderer();
 }
 
-void HProgressBar::stop() {
-    std::lock_guard<std::mutex> lock(mutex);
-    current_segments = total_segments;
-    redraw(true);
-    clearLine();
-    std::cout << progress_label << completed_label << std::endl;
-    showCursor(true);
+/**
+ * \brief Returns the cells taken by everything but the label.
+ *
+ * \note The caller must hold the mutex.
+ */
+size_t HProgressBar::barWidth() const {
+    size_t width = static_cast<size_t>(segments) * filled_glyph.width;
+    if (show_stats) {
+        width += stats_reserve;
+    }
+    if (use_brackets_flag_) {
+        width += open_bracket.width + close_bracket.width;
+    }
+    return width;
 }
 
-void HProgressBar::updateProgress(double new_percentage) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (new_percentage < 0) new_percentage = 0;
-    if (new_percentage > 100) new_percentage = 100;
+/**
+ * \brief Chooses the number of segments that fits the terminal.
+ *
+ * The bar is shrunk first, down to min_segments, and only then does the
+ * label get shortened by fittedLabel(). The stats are left out when not
+ * even the narrowest bar fits next to them. Called only when the width,
+ * the label or the space reserved for the stats changed, not for every
+ * frame.
+ *
+ * \param columns Terminal width, or 0 for no limit.
+ * \note The caller must hold the mutex.
+ */
+void HProgressBar::layout(size_t columns) {
+    layout_columns = columns;
+    layout_generation = label_generation;
+    layout_stats_reserve = stats_reserve;
 
-    current_segments = static_cast<int>(std::round(new_percentage / 100 * total_segments));
-    redraw(false);
-}
+    size_t brackets = use_brackets_flag_ ? open_bracket.width + close_bracket.width : 0;
+    int minimum = std::min(total_segments, min_segments);
+    show_stats = fitsLine(columns, brackets + static_cast<size_t>(minimum) * filled_glyph.width + stats_reserve);
 
-void HProgressBar::updateText(const std::string& new_text) {
-    std::lock_guard<std::mutex> lock(mutex);
-    progress_label = new_text;
-    redraw(false);
+    int fitting = total_segments;
+    if (columns > 0) {
+        // Brackets, stats and the free last column
+        size_t fixed = brackets + (show_stats ? stats_reserve : 0) + 1;
+        size_t label = labelWidth();
+        size_t room = columns > fixed + label ? columns - fixed - label : 0;
+        fitting = static_cast<int>(std::min(room / filled_glyph.width, static_cast<size_t>(total_segments)));
+        if (fitting < minimum) {
+            size_t bar_room = columns > fixed ? (columns - fixed) / filled_glyph.width : 0;
+            fitting = static_cast<int>(std::min(bar_room, static_cast<size_t>(minimum)));
+        }
+        fitting = std::max(fitting, 1);
+    }
+    if (fitting != segments) {
+        segments = fitting;
+        resizeUnits(segments * steps_per_segment);
+    }
 }
 
-void HProgressBar::redraw(bool is_final) {
-    clearLine();
-    std::cout << progress_label;
+/**
+ * \brief Appends the visible content of the bar to line.
+ *
+ * On a terminal the line is fitted to its width: the bar narrows and the
+ * label is shortened with an ellipsis rather than letting the line wrap.
+ * Once stopped, the bar shows its completed label instead.
+ *
+ * \note The caller must hold the mutex.
+ */
+void HProgressBar::composeLine(std::string& line) {
+    size_t columns = console.columns();
+    if (finished) {
+        line += fittedLabel(columns, completedWidth());
+        line += completed_label;
+        return;
+    }
+
+    // Throughput and ETA, when counting work units; always ASCII
+    composeStats();
 
-    char empty_char = progress_chars[0][0];
-    char filled_char = progress_chars[1][0];
+    if (columns != layout_columns || label_generation != layout_generation ||
+        stats_reserve != layout_stats_reserve) {
+        layout(columns);
+    }
+    line += fittedLabel(columns, barWidth());
 
     // Start bracket
     if (use_brackets_flag_) {
-        std::cout << bracket_chars[0];
+        line += open_bracket.bytes;
     }
 
-    // Progress bar
-    for (int i = 0; i < current_segments; ++i) {
-        std::cout << filled_char;
-    }
-    for (int i = current_segments; i < total_segments; ++i) {
-        std::cout << empty_char;
+    // Progress bar: full segments, at most one partial segment, empty segments
+    int full_segments = current_units / steps_per_segment;
+    int partial_step = current_units % steps_per_segment;
+    int empty_segments = segments - full_segments;
+    line.append(filled_run, 0, static_cast<size_t>(full_segments) * filled_glyph.bytes.size());
+    if (partial_step > 0) {
+        line += partial_glyphs[static_cast<size_t>(partial_step - 1)].bytes;
+        --empty_segments;
     }
+    line.append(empty_run, 0, static_cast<size_t>(empty_segments) * empty_glyph.bytes.size());
 
     // End bracket
     if (use_brackets_flag_) {
-        std::cout << bracket_chars[1];
+        line += close_bracket.bytes;
     }
 
-    if (!is_final) {
-        std::cout << std::flush;
+    if (show_stats) {
+        line += stats_text;
     }
 }
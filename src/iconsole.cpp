@@ -1,15 +1,163 @@
 #include "progress_spinner/iconsole.hpp"
+#include <atomic>
+#include <iostream>
+
+namespace {
+
+/**
+ * \brief Slot holding the current sink.
+ *
+ * Allocated once and never destroyed, so that consoles used during static
+ * destruction still find a sink.
+ */
+std::shared_ptr<OutputSink>& sinkSlot() {
+    static std::shared_ptr<OutputSink>* slot = new std::shared_ptr<OutputSink>(std::make_shared<FdSink>());
+    return *slot;
+}
+
+// Sink of the outermost FrameScope of this thread, if any
+thread_local OutputSink* frame_sink = nullptr;
+
+} // namespace
+
+/**
+ * \brief Returns the sink all consoles currently write to.
+ */
+std::shared_ptr<OutputSink> IConsole::sink() {
+    return std::atomic_load(&sinkSlot());
+}
+
+/**
+ * \brief Replaces the sink all consoles write to.
+ *
+ * Takes effect with the next frame of every indicator. Indicators that are
+ * drawing in place should be stopped first, since the new sink does not
+ * show what was drawn to the old one. The old sink is released once the
+ * last frame written to it is complete. Text already printed to std::cout
+ * is flushed first, so no frame of the new sink overtakes it.
+ *
+ * \param new_sink The new sink; nullptr restores standard output.
+ */
+void IConsole::setSink(std::shared_ptr<OutputSink> new_sink) {
+    if (!new_sink) {
+        new_sink = std::make_shared<FdSink>();
+    }
+    std::cout.flush();
+    std::atomic_store(&sinkSlot(), std::move(new_sink));
+}
+
+/**
+ * \brief Constructor for FrameScope; loads the current sink unless an outer
+ * scope of this thread already did.
+ */
+IConsole::FrameScope::FrameScope() {
+    if (frame_sink == nullptr) {
+        held = sink();
+        frame_sink = held.get();
+    }
+}
+
+/**
+ * \brief Destructor for FrameScope; releases the sink if this is the
+ * outermost scope.
+ */
+IConsole::FrameScope::~FrameScope() {
+    if (held) {
+        frame_sink = nullptr;
+    }
+}
+
+/**
+ * \brief Checks whether the sink is a terminal that can be drawn on in place.
+ */
+bool IConsole::isTerminal() const {
+    if (frame_sink != nullptr) {
+        return frame_sink->isTerminal();
+    }
+    return sink()->isTerminal();
+}
+
+/**
+ * \brief Returns the width of the terminal in cells.
+ *
+ * \return The width, or 0 if it is unknown or the sink is not a terminal;
+ *         lines are then not limited in width.
+ */
+size_t IConsole::columns() const {
+    if (frame_sink != nullptr) {
+        return frame_sink->columns();
+    }
+    return sink()->columns();
+}
+
+/**
+ * \brief Returns the number of bytes the sink has accepted but not yet
+ * delivered, or 0 if it cannot tell.
+ */
+size_t IConsole::pendingBytes() const {
+    if (frame_sink != nullptr) {
+        return frame_sink->pendingBytes();
+    }
+    return sink()->pendingBytes();
+}
+
+/**
+ * \brief Writes a composed frame to the sink in one call.
+ *
+ * \param[in] data The bytes to write.
+ * \param[in] size Number of bytes to write.
+ * \return false if the sink dropped the frame; the caller must then assume
+ *         that nothing of it reached the screen.
+ */
+bool IConsole::write(const char* data, size_t size) const {
+    if (frame_sink != nullptr) {
+        return frame_sink->write(data, size);
+    }
+    return sink()->write(data, size);
+}
+
+/**
+ * \brief Writes a composed frame to the sink in one call, with the sources
+ * of its bytes.
+ *
+ * \param[in] data The bytes to write.
+ * \param[in] size Number of bytes to write.
+ * \param[in] spans Source of each part of data, in order.
+ * \param[in] span_count Number of spans.
+ * \return false if the sink dropped the frame.
+ */
+bool IConsole::writeFrame(const char* data, size_t size, const FrameSpan* spans, size_t span_count) const {
+    if (frame_sink != nullptr) {
+        return frame_sink->writeFrame(data, size, spans, span_count);
+    }
+    return sink()->writeFrame(data, size, spans, span_count);
+}
+
+/**
+ * \brief Waits until the sink has written everything it has accepted.
+ */
+void IConsole::flush() const {
+    if (frame_sink != nullptr) {
+        frame_sink->flush();
+        return;
+    }
+    sink()->flush();
+}
 
 #ifdef _WIN32
 
 /**
  * \brief Constructor for WindowsConsole
  *
- * Enables UTF-8 output and ANSI escape sequences in the console.
+ * Enables UTF-8 output and ANSI escape sequences in the console, if
+ * standard output is one. Redirected output is left alone.
  */
 WindowsConsole::WindowsConsole() {
-    setUTF8();
-    enableANSISupport();
+    DWORD mode = 0;
+    if (GetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), &mode)) {
+        setUTF8();
+        enableANSISupport();
+    }
 }
 
 /**
@@ -19,9 +167,14 @@ WindowsConsole::WindowsConsole() {
  * It retrieves the current console cursor information, sets the visibility to the
  * given flag, and then sets the information back to the console.
  *
+ * Does nothing if the sink is not a terminal.
+ *
  * \param[in] show_flag true to show the cursor, false to hide it.
  */
 void WindowsConsole::showCursor(bool show_flag) const {
+    if (!isTerminal()) {
+        return;
+    }
     HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
     CONSOLE_CURSOR_INFO cursor_info;
     GetConsoleCursorInfo(out, &cursor_info);
@@ -61,11 +214,15 @@ void WindowsConsole::enableANSISupport() const {
  *
  * This function manipulates the console's cursor visibility using ANSI escape sequences.
  * It outputs the appropriate escape sequence to show or hide the cursor, as requested.
+ * Nothing is written if the sink is not a terminal.
  *
  * \param[in] show_flag true to show the cursor, false to hide it.
  */
 void UnixConsole::showCursor(bool show_flag) const {
-    std::cout << (show_flag ? "\033[?25h" : "\033[?25l");
+    if (!isTerminal()) {
+        return;
+    }
+    write(show_flag ? "\033[?25h" : "\033[?25l", 6);
 }
 
 #endif
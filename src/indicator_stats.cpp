@@ -0,0 +1,144 @@
+#include "progress_spinner/indicator_stats.hpp"
+#include <cstdio>
+
+namespace {
+
+// Ids start at 1; 0 marks an unused entry of the thread-local cell cache
+std::atomic<uint64_t> next_counters_id(1);
+
+} // namespace
+
+/**
+ * \brief Estimates a latency percentile from the histogram.
+ *
+ * \param fraction The percentile as a fraction, e.g. 0.99.
+ * \return The upper bound of the bucket holding the percentile, in
+ *         microseconds, or 0 if no latency was recorded.
+ */
+double IndicatorStats::latencyPercentileUs(double fraction) const {
+    uint64_t total = 0;
+    for (uint64_t count : latency_histogram) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < latency_buckets; ++i) {
+        seen += latency_histogram[i];
+        if (seen >= rank) {
+            return static_cast<double>(uint64_t(1) << i);
+        }
+    }
+    return static_cast<double>(uint64_t(1) << (latency_buckets - 1));
+}
+
+/**
+ * \brief Formats the counters as a single line of key=value pairs.
+ */
+std::string IndicatorStats::toString() const {
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer),
+                  "updates=%llu frames=%llu skipped=%llu bytes=%llu mutex_hold_us=%.1f latency_p50_us<=%.0f latency_p99_us<=%.0f",
+                  static_cast<unsigned long long>(updates),
+                  static_cast<unsigned long long>(frames_rendered),
+                  static_cast<unsigned long long>(frames_skipped),
+                  static_cast<unsigned long long>(bytes_written),
+                  static_cast<double>(mutex_hold_ns) / 1000.0,
+                  latencyPercentileUs(0.5),
+                  latencyPercentileUs(0.99));
+    return buffer;
+}
+
+/**
+ * \brief Constructor for IndicatorCounters.
+ *
+ * All counters start at zero. Every instance gets an id of its own, so a
+ * thread never mistakes the cell it cached for a destroyed instance for one
+ * of a new instance at the same address.
+ */
+IndicatorCounters::IndicatorCounters()
+    : counters_id(next_counters_id.fetch_add(1, std::memory_order_relaxed)),
+      update_cells(nullptr),
+      frames_rendered(0),
+      frames_skipped(0),
+      bytes_written(0),
+      mutex_hold_ns(0) {
+    for (std::atomic<uint64_t>& bucket : latency_histogram) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief Destructor for IndicatorCounters; frees the cells of every thread.
+ */
+IndicatorCounters::~IndicatorCounters() {
+    UpdateCell* cell = update_cells.load(std::memory_order_acquire);
+    while (cell != nullptr) {
+        UpdateCell* next = cell->next;
+        delete cell;
+        cell = next;
+    }
+}
+
+/**
+ * \brief Returns the cell of the calling thread, creating it on first use.
+ *
+ * Only taken when the thread-local cache misses, i.e. on the first update
+ * from a thread or after another instance took its cache entry. Cells are
+ * never removed before the counters go away, and a thread whose id is
+ * reused by a later thread hands its cell on to it.
+ */
+IndicatorCounters::UpdateCell& IndicatorCounters::findCell() {
+    std::thread::id thread = std::this_thread::get_id();
+    UpdateCell* head = update_cells.load(std::memory_order_acquire);
+    for (UpdateCell* cell = head; cell != nullptr; cell = cell->next) {
+        if (cell->thread == thread) {
+            return *cell;
+        }
+    }
+    UpdateCell* cell = new UpdateCell();
+    cell->thread = thread;
+    cell->next = head;
+    while (!update_cells.compare_exchange_weak(cell->next, cell, std::memory_order_release,
+                                               std::memory_order_acquire)) {
+    }
+    return *cell;
+}
+
+/**
+ * \brief Adds a frame latency to the histogram.
+ *
+ * \param latency Time from when the frame was due until it reached the sink.
+ */
+void IndicatorCounters::countLatency(Clock::duration latency) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    size_t bucket = 0;
+    while (bucket + 1 < IndicatorStats::latency_buckets && us >= (int64_t(1) << bucket)) {
+        ++bucket;
+    }
+    latency_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * \brief Returns the current value of every counter.
+ *
+ * The counters are read one by one, so a snapshot taken while the indicator
+ * is in use may be off by the updates that happened meanwhile.
+ */
+IndicatorStats IndicatorCounters::snapshot() const {
+    IndicatorStats stats;
+    for (UpdateCell* cell = update_cells.load(std::memory_order_acquire); cell != nullptr; cell = cell->next) {
+        stats.updates += cell->count.load(std::memory_order_relaxed);
+    }
+    stats.frames_rendered = frames_rendered.load(std::memory_order_relaxed);
+    stats.frames_skipped = frames_skipped.load(std::memory_order_relaxed);
+    stats.bytes_written = bytes_written.load(std::memory_order_relaxed);
+    stats.mutex_hold_ns = mutex_hold_ns.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < IndicatorStats::latency_buckets; ++i) {
+        stats.latency_histogram[i] = latency_histogram[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
@@ -0,0 +1,82 @@
+#include "progress_spinner/log_line.hpp"
+#include <cmath>
+
+/**
+ * \brief Constructor for LogLine.
+ *
+ * \param interval_sec Minimum seconds between two lines; 0 disables lines
+ *                     driven by time.
+ * \param percent_step Percent step that always gets a line; 0 disables lines
+ *                     driven by progress.
+ */
+LogLine::LogLine(int interval_sec, int percent_step)
+    : interval(interval_sec),
+      percent_step(percent_step),
+      logged_step(-1),
+      has_logged(false) {}
+
+/**
+ * \brief Appends line to frame if a new log line is due.
+ *
+ * A line identical to the last one logged is never repeated.
+ *
+ * \param line The composed line, without control sequences.
+ * \param percentage Progress in percent, or a negative value if the
+ *                   indicator has no notion of progress.
+ * \param frame The frame buffer to append to.
+ */
+void LogLine::update(const std::string& line, double percentage, std::string& frame) {
+    if (has_logged && line == logged) {
+        return;
+    }
+
+    Clock::time_point now = Clock::now();
+    int step = stepOf(percentage);
+    bool due = !has_logged
+        || (interval.count() > 0 && now - logged_at >= interval)
+        || step != logged_step;
+    if (due) {
+        log(line, step, now, frame);
+    }
+}
+
+/**
+ * \brief Appends the final line to frame, unless it was already logged.
+ *
+ * The next update() starts a new log, e.g. for a restarted indicator.
+ *
+ * \param line The composed final line.
+ * \param frame The frame buffer to append to.
+ */
+void LogLine::finish(const std::string& line, std::string& frame) {
+    if (!has_logged || line != logged) {
+        frame += line;
+        frame += '\n';
+    }
+    has_logged = false;
+    logged_step = -1;
+}
+
+/**
+ * \brief Maps a percentage to the index of its percent step.
+ *
+ * \return The step index, or -1 without progress or percent steps.
+ */
+int LogLine::stepOf(double percentage) const {
+    if (percent_step <= 0 || percentage < 0) {
+        return -1;
+    }
+    if (percentage > 100) {
+        percentage = 100;
+    }
+    return static_cast<int>(std::floor(percentage / percent_step));
+}
+
+void LogLine::log(const std::string& line, int step, Clock::time_point now, std::string& frame) {
+    frame += line;
+    frame += '\n';
+    logged = line;
+    logged_at = now;
+    logged_step = step;
+    has_logged = true;
+}
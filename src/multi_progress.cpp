@@ -0,0 +1,398 @@
+#include "progress_spinner/multi_progress.hpp"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * \brief Constructor for MultiProgress.
+ *
+ * \param options MultiProgressOptions with the refresh rate of the block and
+ *                whether to capture the standard streams.
+ */
+MultiProgress::MultiProgress(const MultiProgressOptions& options)
+    : console(),
+      frame_start(0),
+      refresh_rate_hz(options.refresh_rate_hz),
+      capture_streams(options.capture_streams),
+      drawn_rows(0),
+      previous_drawn_rows(0),
+      pending_logs(nullptr),
+      running(false) {}
+
+/**
+ * \brief Destructor for MultiProgress.
+ *
+ * Stops the block if it is still running; the rows are destroyed with it.
+ */
+MultiProgress::~MultiProgress() {
+    stop();
+}
+
+/**
+ * \brief Hides the cursor and starts redrawing the block.
+ *
+ * With option::CaptureStreams, std::cout and std::cerr are captured from
+ * here on; start and stop the block while no other thread writes to them.
+ */
+void MultiProgress::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return;
+        }
+        running = true;
+    }
+    if (capture_streams) {
+        StreamCapture::LineHandler print_line = [this](const std::string& line) { println(line); };
+        captured_out.reset(new StreamCapture(std::cout, print_line));
+        captured_err.reset(new StreamCapture(std::cerr, print_line));
+    }
+    console.flush();
+    console.showCursor(false);
+    RenderScheduler::instance().add(this, std::chrono::microseconds(1000000 / refresh_rate_hz));
+}
+
+/**
+ * \brief Draws the final state of every row and releases the terminal.
+ *
+ * The cursor is left on the line below the block and shown again. Captured
+ * streams get their buffers back, and lines still queued are printed above
+ * the final state.
+ */
+void MultiProgress::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    RenderScheduler::instance().remove(this);
+    captured_err.reset();
+    captured_out.reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    frame_buffer.clear();
+    drawn_in_frame.clear();
+    frame_start = 0;
+    takeLogs();
+    appendLogs(frame_buffer);
+    log_text.clear();
+    if (!console.isTerminal()) {
+        logFinalLines(frame_buffer);
+    } else {
+        composeBlock(frame_buffer);
+    }
+    if (drawn_rows > 0) {
+        frame_buffer += '\n';
+    }
+    drawn_rows = 0;
+    for (ScreenLine& screen_line : screen_lines) {
+        screen_line.invalidate();
+    }
+    console.flush();
+    std::vector<FrameSpan> frame_spans;
+    appendSpans(frame_buffer.size(), frame_spans);
+    if (console.writeFrame(frame_buffer.data(), frame_buffer.size(), frame_spans.data(), frame_spans.size())) {
+        countDrawnRows();
+    }
+    console.showCursor(true);
+}
+
+/**
+ * \brief Prints a line above the block.
+ *
+ * Safe to call from any thread; the line is only queued, so the caller never
+ * waits for the block's mutex or the terminal while the block is running. On
+ * the next frame the block is cleared, the queued lines are printed in the
+ * order they were logged and the block is redrawn beneath them, all in one
+ * write, so the lines never tear through the bars. When the block is not
+ * running, the line is printed right away.
+ *
+ * \param text The line, without the trailing newline.
+ */
+void MultiProgress::println(const std::string& text) {
+    LogMessage* message = new LogMessage{text, pending_logs.load(std::memory_order_relaxed)};
+    while (!pending_logs.compare_exchange_weak(message->next, message, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+    }
+    // Checked after queueing: stop() clears running before it prints what
+    // is queued, so one of the two always prints the line
+    if (running.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running.load()) {
+        return;
+    }
+    // The block may still be on screen while stop() is on its way
+    std::string frame;
+    takeLogs();
+    appendLogs(frame);
+    log_text.clear();
+    console.write(frame.data(), frame.size());
+}
+
+/**
+ * \brief Returns the rate the block is drawn at right now.
+ *
+ * Lower than the configured rate while the output is backed up, see
+ * FramePacer.
+ */
+double MultiProgress::frameRateHz() const {
+    return RenderScheduler::instance().pacer().rateHz(std::chrono::microseconds(1000000 / refresh_rate_hz));
+}
+
+/**
+ * \brief Takes ownership of a row created by add().
+ *
+ * \param row The new row.
+ */
+void MultiProgress::append(std::unique_ptr<ProgressIndicator> row) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rows.push_back(std::move(row));
+    lines.emplace_back();
+    screen_lines.emplace_back();
+}
+
+/**
+ * \brief Scheduler callback that redraws the block.
+ *
+ * \param frame Batch buffer to append to.
+ */
+void MultiProgress::renderFrame(std::string& frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    drawn_in_frame.clear();
+    frame_start = frame.size();
+    takeLogs();
+    previous_drawn_rows = drawn_rows;
+    appendLogs(frame);
+    if (!console.isTerminal()) {
+        logLines(frame);
+        return;
+    }
+    composeBlock(frame);
+}
+
+/**
+ * \brief Scheduler callback for a frame that reached the sink.
+ *
+ * Counts the frame and records the latency for every row drawn in it.
+ *
+ * \param latency Time from when the frame was due until it was written.
+ */
+void MultiProgress::frameWritten(std::chrono::steady_clock::duration latency) {
+    std::lock_guard<std::mutex> lock(mutex);
+    log_text.clear();
+    countDrawnRows();
+    for (const DrawnRow& drawn : drawn_in_frame) {
+        rows[drawn.row]->counters.countLatency(latency);
+    }
+}
+
+/**
+ * \brief Remembers the bytes row added to the frame, or counts the row as
+ * skipped if it added none.
+ *
+ * The row's frame is only counted once the frame reaches the sink.
+ *
+ * \param row Index of the row.
+ * \param start Size of the frame before the row was drawn.
+ * \param end Size of the frame after the row was drawn.
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::countRowFrame(size_t row, size_t start, size_t end) {
+    if (start == end) {
+        rows[row]->counters.countSkipped();
+        return;
+    }
+    drawn_in_frame.push_back(DrawnRow{row, start - frame_start, end - start});
+}
+
+/**
+ * \brief Scheduler callback that reports which row drew which bytes of the
+ * frame just rendered.
+ *
+ * \param size Bytes the block appended to the batch.
+ * \param frame_spans Receives the spans.
+ */
+void MultiProgress::frameSpans(size_t size, std::vector<FrameSpan>& frame_spans) {
+    std::lock_guard<std::mutex> lock(mutex);
+    appendSpans(size, frame_spans);
+}
+
+/**
+ * \brief Appends the spans of the block's part of the frame in flight.
+ *
+ * The bytes of each drawn row are attributed to the row's indicator id;
+ * logged lines, clearing and cursor moves between the rows are the block's
+ * own, with source id 0.
+ *
+ * \param size Bytes of the block's part of the frame.
+ * \param frame_spans Receives the spans, in order.
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::appendSpans(size_t size, std::vector<FrameSpan>& frame_spans) const {
+    size_t position = 0;
+    for (const DrawnRow& drawn : drawn_in_frame) {
+        if (drawn.offset > position) {
+            frame_spans.push_back(FrameSpan{0, drawn.offset - position});
+        }
+        frame_spans.push_back(FrameSpan{rows[drawn.row]->indicator_id, drawn.bytes});
+        position = drawn.offset + drawn.bytes;
+    }
+    if (size > position) {
+        frame_spans.push_back(FrameSpan{0, size - position});
+    }
+}
+
+/**
+ * \brief Counts a frame for every row drawn into the frame just written.
+ *
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::countDrawnRows() {
+    for (const DrawnRow& drawn : drawn_in_frame) {
+        rows[drawn.row]->counters.countFrame(drawn.bytes);
+    }
+}
+
+/**
+ * \brief Scheduler callback for a frame the sink dropped.
+ *
+ * Nothing of the frame reached the screen, so the cursor is still on the
+ * last row drawn before it. Every row is redrawn in full with the next frame,
+ * and the logged lines the frame carried are printed with it.
+ */
+void MultiProgress::frameDropped() {
+    std::lock_guard<std::mutex> lock(mutex);
+    drawn_rows = previous_drawn_rows;
+    for (ScreenLine& screen_line : screen_lines) {
+        screen_line.invalidate();
+    }
+}
+
+/**
+ * \brief Moves the lines queued by println() to log_text, oldest first.
+ *
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::takeLogs() {
+    LogMessage* message = pending_logs.exchange(nullptr, std::memory_order_acquire);
+    // The queue is a stack; reverse it to print in the order logged
+    LogMessage* oldest = nullptr;
+    while (message != nullptr) {
+        LogMessage* next = message->next;
+        message->next = oldest;
+        oldest = message;
+        message = next;
+    }
+    while (oldest != nullptr) {
+        log_text += oldest->text;
+        log_text += '\n';
+        LogMessage* next = oldest->next;
+        delete oldest;
+        oldest = next;
+    }
+}
+
+/**
+ * \brief Appends the logged lines not yet written to frame.
+ *
+ * On a terminal the block is cleared first, from its top row down, and every
+ * row is redrawn beneath the lines by the following composeBlock(). The lines
+ * are kept until the frame is known to be written.
+ *
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::appendLogs(std::string& frame) {
+    if (log_text.empty()) {
+        return;
+    }
+    if (console.isTerminal() && drawn_rows > 0) {
+        frame += '\r';
+        if (drawn_rows > 1) {
+            ScreenLine::appendCursorMove(frame, drawn_rows - 1, 'A');
+        }
+        frame += "\033[J";
+        drawn_rows = 0;
+        for (ScreenLine& screen_line : screen_lines) {
+            screen_line.invalidate();
+        }
+    }
+    frame += log_text;
+}
+
+/**
+ * \brief Appends the plain log lines that are due to frame.
+ *
+ * Used instead of composeBlock() when standard output is not a terminal.
+ * Rows are not drawn as a block; each row logs on its own, following the
+ * log policy from its options.
+ *
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::logLines(std::string& frame) {
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ProgressIndicator& row = *rows[i];
+        TimedLock row_lock(row.mutex, row.counters);
+        if (row.refresh() || lines[i].empty()) {
+            size_t frame_size = frame.size();
+            lines[i].clear();
+            row.composeLine(lines[i]);
+            row.log_line.update(lines[i], row.shownPercentage(), frame);
+            countRowFrame(i, frame_size, frame.size());
+        }
+    }
+}
+
+/**
+ * \brief Appends the final log line of every row to frame.
+ *
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::logFinalLines(std::string& frame) {
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ProgressIndicator& row = *rows[i];
+        TimedLock row_lock(row.mutex, row.counters);
+        row.refresh();
+        lines[i].clear();
+        row.composeLine(lines[i]);
+        row.log_line.finish(lines[i], frame);
+    }
+}
+
+/**
+ * \brief Appends the changes to the block since the last frame to frame.
+ *
+ * Each row's line is only recomposed when the row reports a change, and only
+ * rows whose content differs from what is on screen are visited. Rows added
+ * since the last frame are appended below the block. Between frames the
+ * cursor rests on the last row, so a frame without changes appends nothing.
+ *
+ * \note The caller must hold the mutex.
+ */
+void MultiProgress::composeBlock(std::string& frame) {
+    size_t cursor_row = drawn_rows > 0 ? drawn_rows - 1 : 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ProgressIndicator& row = *rows[i];
+        {
+            TimedLock row_lock(row.mutex, row.counters);
+            if (row.refresh() || i >= drawn_rows) {
+                lines[i].clear();
+                row.composeLine(lines[i]);
+            }
+        }
+        if (i < drawn_rows && screen_lines[i].shows(lines[i])) {
+            row.counters.countSkipped();
+            continue;
+        }
+        size_t frame_size = frame.size();
+        ScreenLine::moveToRow(frame, drawn_rows, cursor_row, i);
+        screen_lines[i].update(lines[i], frame);
+        countRowFrame(i, frame_size, frame.size());
+        drawn_rows = std::max(drawn_rows, i + 1);
+    }
+    if (drawn_rows > 0) {
+        ScreenLine::moveToRow(frame, drawn_rows, cursor_row, drawn_rows - 1);
+    }
+}
@@ -1,4 +1,6 @@
 #include "progress_spinner/options.hpp"
+#include "progress_spinner/text_width.hpp"
+#include <stdexcept>
 
 /**
  * \brief Constructor for ProgressSpinnerOptions.
@@ -7,15 +9,23 @@
  * \param completed_label The string to display when the task is complete.
  * \param char_frames A sequence of characters used to represent the spinner.
  * \param update_interval_ms The interval in milliseconds between each frame update.
+ * \param log_interval Seconds between plain lines when standard output is not
+ *                     a terminal.
  */
 ProgressSpinnerOptions::ProgressSpinnerOptions(const option::Label& label,
                                                const option::CompletedLabel& completed_label,
                                                const option::CharFrames& char_frames,
-                                               const option::UpdateIntervalMs& update_interval_ms)
+                                               const option::UpdateIntervalMs& update_interval_ms,
+                                               const option::LogIntervalSec& log_interval)
     : progress_label(label.progress_label),
       completed_label(completed_label.completed_label),
       chars(char_frames),
-      update_interval_ms(update_interval_ms.update_interval_ms) {}
+      update_interval_ms(update_interval_ms.update_interval_ms),
+      log_interval_sec(log_interval.log_interval_sec) {
+        if (log_interval_sec < 0) {
+            throw std::invalid_argument("ProgressSpinnerOptions: log_interval_sec cannot be negative, got " + std::to_string(log_interval_sec));
+        }
+}
 
 /**
  * \brief Constructor for HProgressBarOptions.
@@ -27,20 +37,33 @@ ProgressSpinnerOptions::ProgressSpinnerOptions(const option::Label& label,
  *                    The first character is used for empty segments, and the last
  *                    character is used for filled segments. If the sequence is
  *                    less than 2 characters, the default of "░" and "█" is used.
+ * \param refresh_rate Maximum redraws per second, or 0 to redraw on every
+ *                     update.
+ * \param partial_chars Glyphs for partially filled segments, from least to
+ *                      most filled. Empty disables partial segments.
+ * \param log_interval Seconds between plain lines when standard output is not
+ *                     a terminal.
+ * \param log_step Percent step that gets a plain line when standard output is
+ *                 not a terminal.
  */
-#include "progress_spinner/options.hpp"
-#include <stdexcept>
-
 HProgressBarOptions::HProgressBarOptions(const option::Label& label,
                                          const option::CompletedLabel& completed_label,
                                          const option::NumOfSegments& segments,
                                          const option::ProgressChars& progress_chars,
-                                         const option::BracketChars& bracket_chars)
+                                         const option::BracketChars& bracket_chars,
+                                         const option::RefreshRateHz& refresh_rate,
+                                         const option::PartialChars& partial_chars,
+                                         const option::LogIntervalSec& log_interval,
+                                         const option::LogPercentStep& log_step)
     : progress_label(label.progress_label),
       completed_label(completed_label.completed_label),
       total_segments(segments.number_of_segments),
       progress_chars(progress_chars),
-      bracket_chars(bracket_chars) {
+      bracket_chars(bracket_chars),
+      refresh_rate_hz(refresh_rate.refresh_rate_hz),
+      partial_chars(partial_chars),
+      log_interval_sec(log_interval.log_interval_sec),
+      log_percent_step(log_step.log_percent_step) {
         if (progress_chars.size() != 2) {
             throw std::invalid_argument("HProgressBarOptions: progress_chars must have exactly 2 elements (for empty and filled states), got " + std::to_string(progress_chars.size()));
         }
@@ -50,6 +73,62 @@ HProgressBarOptions::HProgressBarOptions(const option::Label& label,
         if (bracket_chars.size() != 2) {
             throw std::invalid_argument("HProgressBarOptions: bracket_chars must have 2 elements, got " + std::to_string(bracket_chars.size()));
         }
+        for (const std::string& glyph : progress_chars) {
+            if (!isValidUtf8(glyph)) {
+                throw std::invalid_argument("HProgressBarOptions: progress_chars must be valid UTF-8");
+            }
+        }
+        for (const std::string& glyph : bracket_chars) {
+            if (!isValidUtf8(glyph)) {
+                throw std::invalid_argument("HProgressBarOptions: bracket_chars must be valid UTF-8");
+            }
+        }
+        size_t empty_width = displayWidth(progress_chars[0]);
+        size_t filled_width = displayWidth(progress_chars[1]);
+        if (empty_width == 0 || empty_width != filled_width) {
+            throw std::invalid_argument("HProgressBarOptions: progress_chars must have the same, non-zero display width, got " + std::to_string(empty_width) + " and " + std::to_string(filled_width));
+        }
+        for (const std::string& glyph : partial_chars) {
+            if (!isValidUtf8(glyph) || displayWidth(glyph) != filled_width) {
+                throw std::invalid_argument("HProgressBarOptions: partial_chars must be valid UTF-8 with the same display width as progress_chars");
+            }
+        }
+        if (refresh_rate_hz < 0) {
+            throw std::invalid_argument("HProgressBarOptions: refresh_rate_hz cannot be negative, got " + std::to_string(refresh_rate_hz));
+        }
+        if (log_interval_sec < 0 || log_percent_step < 0) {
+            throw std::invalid_argument("HProgressBarOptions: log_interval_sec and log_percent_step cannot be negative");
+        }
+}
+
+/**
+ * \brief Constructor for BasicHProgressBarOptions.
+ *
+ * \param label The initial label string.
+ * \param completed_label The string to display when the task is complete.
+ * \param refresh_rate Maximum redraws per second, or 0 to redraw on every
+ *                     update.
+ * \param log_interval Seconds between plain lines when standard output is not
+ *                     a terminal.
+ * \param log_step Percent step that gets a plain line when standard output is
+ *                 not a terminal.
+ */
+BasicHProgressBarOptions::BasicHProgressBarOptions(const option::Label& label,
+                                                   const option::CompletedLabel& completed_label,
+                                                   const option::RefreshRateHz& refresh_rate,
+                                                   const option::LogIntervalSec& log_interval,
+                                                   const option::LogPercentStep& log_step)
+    : progress_label(label.progress_label),
+      completed_label(completed_label.completed_label),
+      refresh_rate_hz(refresh_rate.refresh_rate_hz),
+      log_interval_sec(log_interval.log_interval_sec),
+      log_percent_step(log_step.log_percent_step) {
+        if (refresh_rate_hz < 0) {
+            throw std::invalid_argument("BasicHProgressBarOptions: refresh_rate_hz cannot be negative, got " + std::to_string(refresh_rate_hz));
+        }
+        if (log_interval_sec < 0 || log_percent_step < 0) {
+            throw std::invalid_argument("BasicHProgressBarOptions: log_interval_sec and log_percent_step cannot be negative");
+        }
 }
 
 /**
@@ -62,10 +141,112 @@ HProgressBarOptions::HProgressBarOptions(const option::Label& label,
  *                    segments, and subsequent characters are used for filled
  *                    segments. If the sequence is empty, the default of " ",
  *                    "▁", "▂", "▃", "▄", "▅", "▆", "▇", and "█" is used.
+ * \param refresh_rate Maximum redraws per second, or 0 to redraw on every
+ *                     update.
+ * \param log_interval Seconds between plain lines when standard output is not
+ *                     a terminal.
+ * \param log_step Percent step that gets a plain line when standard output is
+ *                 not a terminal.
  */
 VProgressBarOptions::VProgressBarOptions(const option::Label& label,
                                          const option::CompletedLabel& completed_label,
-                                         const option::CharFrames& char_frames)
+                                         const option::CharFrames& char_frames,
+                                         const option::RefreshRateHz& refresh_rate,
+                                         const option::LogIntervalSec& log_interval,
+                                         const option::LogPercentStep& log_step)
     : progress_label(label.progress_label),
       completed_label(completed_label.completed_label),
-      chars(char_frames) {}
+      chars(char_frames),
+      refresh_rate_hz(refresh_rate.refresh_rate_hz),
+      log_interval_sec(log_interval.log_interval_sec),
+      log_percent_step(log_step.log_percent_step) {
+        if (refresh_rate_hz < 0) {
+            throw std::invalid_argument("VProgressBarOptions: refresh_rate_hz cannot be negative, got " + std::to_string(refresh_rate_hz));
+        }
+        if (log_interval_sec < 0 || log_percent_step < 0) {
+            throw std::invalid_argument("VProgressBarOptions: log_interval_sec and log_percent_step cannot be negative");
+        }
+}
+
+/**
+ * \brief Constructor for TrackOptions.
+ *
+ * \param batch Largest number of items counted locally before they are
+ *              published; must be positive.
+ * \param publish_interval Milliseconds after which pending items are
+ *                         published; must be positive.
+ */
+TrackOptions::TrackOptions(const option::BatchItems& batch,
+                           const option::PublishIntervalMs& publish_interval)
+    : batch_items(batch.batch_items),
+      publish_interval_ms(publish_interval.publish_interval_ms) {
+        if (batch_items <= 0) {
+            throw std::invalid_argument("TrackOptions: batch_items must be greater than 0, got " + std::to_string(batch_items));
+        }
+        if (publish_interval_ms <= 0) {
+            throw std::invalid_argument("TrackOptions: publish_interval_ms must be greater than 0, got " + std::to_string(publish_interval_ms));
+        }
+}
+
+/**
+ * \brief Constructor for MultiProgressOptions.
+ *
+ * \param refresh_rate Maximum redraws per second of the whole block; must be
+ *                     positive.
+ * \param capture_streams Whether to capture std::cout and std::cerr while the
+ *                        block runs.
+ */
+MultiProgressOptions::MultiProgressOptions(const option::RefreshRateHz& refresh_rate,
+                                           const option::CaptureStreams& capture_streams)
+    : refresh_rate_hz(refresh_rate.refresh_rate_hz), capture_streams(capture_streams.capture_streams) {
+        if (refresh_rate_hz <= 0) {
+            throw std::invalid_argument("MultiProgressOptions: refresh_rate_hz must be greater than 0, got " + std::to_string(refresh_rate_hz));
+        }
+}
+
+/**
+ * \brief Constructor for TaskTableOptions.
+ *
+ * \param top_tasks Rows for single tasks below the summary line; must not be
+ *                  negative.
+ * \param task_order Whether the rows show the most active or the slowest
+ *                   running tasks.
+ * \param refresh_rate Maximum redraws per second; must be positive.
+ * \param log_interval Seconds between two summary lines when standard output
+ *                     is not a terminal; 0 prints one at stop only.
+ * \throws std::invalid_argument if a value is out of range.
+ */
+TaskTableOptions::TaskTableOptions(const option::TopTasks& top_tasks, const option::TaskOrder& task_order,
+                                   const option::RefreshRateHz& refresh_rate,
+                                   const option::LogIntervalSec& log_interval)
+    : top_tasks(top_tasks.top_tasks),
+      task_order(task_order.task_order),
+      refresh_rate_hz(refresh_rate.refresh_rate_hz),
+      log_interval_sec(log_interval.log_interval_sec) {
+    if (this->top_tasks < 0) {
+        throw std::invalid_argument("TaskTableOptions: top_tasks cannot be negative, got " +
+                                    std::to_string(this->top_tasks));
+    }
+    if (refresh_rate_hz <= 0) {
+        throw std::invalid_argument("TaskTableOptions: refresh_rate_hz must be greater than 0, got " +
+                                    std::to_string(refresh_rate_hz));
+    }
+    if (log_interval_sec < 0) {
+        throw std::invalid_argument("TaskTableOptions: log_interval_sec cannot be negative, got " +
+                                    std::to_string(log_interval_sec));
+    }
+}
+
+/**
+ * \brief Constructor for ProgressExporterOptions.
+ *
+ * \param export_interval Milliseconds between two snapshots; must be
+ *                        positive.
+ * \throws std::invalid_argument if the interval is not positive.
+ */
+ProgressExporterOptions::ProgressExporterOptions(const option::ExportIntervalMs& export_interval)
+    : export_interval_ms(export_interval.export_interval_ms) {
+        if (export_interval_ms <= 0) {
+            throw std::invalid_argument("ProgressExporterOptions: export_interval_ms must be greater than 0, got " + std::to_string(export_interval_ms));
+        }
+}
@@ -0,0 +1,396 @@
+#include "progress_spinner/output_sink.hpp"
+#include <chrono>
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+
+// Windows has no resize signal, so the width is queried at most this often
+constexpr uint64_t query_interval_ms = 500;
+
+/**
+ * \brief Number of the current query interval; a new one counts as a resize.
+ */
+uint64_t resizeEpoch() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count()) /
+           query_interval_ms;
+}
+
+void watchResizes() {}
+
+#else
+
+// Bumped by the SIGWINCH handler; lock-free atomics are safe to use there
+std::atomic<uint64_t> resize_count(0);
+struct sigaction previous_winch_action;
+
+/**
+ * \brief SIGWINCH handler: marks every cached width as stale.
+ *
+ * Calls the handler that was installed before, if any, so the application
+ * still sees the signal.
+ */
+extern "C" void onWindowChange(int signal, siginfo_t* info, void* context) {
+    resize_count.fetch_add(1, std::memory_order_relaxed);
+    if (previous_winch_action.sa_flags & SA_SIGINFO) {
+        if (previous_winch_action.sa_sigaction != nullptr) {
+            previous_winch_action.sa_sigaction(signal, info, context);
+        }
+    } else if (previous_winch_action.sa_handler != SIG_DFL && previous_winch_action.sa_handler != SIG_IGN) {
+        previous_winch_action.sa_handler(signal);
+    }
+}
+
+/**
+ * \brief Number of resizes seen so far.
+ */
+uint64_t resizeEpoch() {
+    return resize_count.load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief Installs the SIGWINCH handler, once per process.
+ */
+void watchResizes() {
+    static bool installed = []() {
+        struct sigaction action = {};
+        action.sa_sigaction = onWindowChange;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        return sigaction(SIGWINCH, &action, &previous_winch_action) == 0;
+    }();
+    (void)installed;
+}
+
+#endif
+
+} // namespace
+
+/**
+ * \brief Constructor for FdSink.
+ *
+ * Checks once whether the descriptor is a terminal and, if it is, measures
+ * its width and starts watching for resizes. Then flushes std::cout, see
+ * flush().
+ *
+ * \param fd The file descriptor to write to; it is not closed by the sink.
+ */
+FdSink::FdSink(int fd) : fd(fd), cached_columns(0), measured_at(0) {
+#ifdef _WIN32
+    terminal = _isatty(fd) != 0;
+#else
+    terminal = isatty(fd) != 0;
+#endif
+    if (terminal) {
+        watchResizes();
+        measured_at.store(resizeEpoch(), std::memory_order_relaxed);
+        cached_columns.store(queryColumns(), std::memory_order_relaxed);
+    }
+    flush();
+}
+
+/**
+ * \brief Flushes std::cout when writing to standard output, so text printed
+ * so far is not overtaken by the next frame.
+ *
+ * Writes themselves are never buffered.
+ */
+void FdSink::flush() {
+    if (fd == 1) {
+        std::cout.flush();
+    }
+}
+
+/**
+ * \brief Returns the width of the terminal in cells.
+ *
+ * Cheap enough to call for every frame: the terminal is only asked again
+ * after a resize.
+ *
+ * \return The width, or 0 if the descriptor is not a terminal or its width
+ *         is unknown.
+ */
+size_t FdSink::columns() const {
+    if (!terminal) {
+        return 0;
+    }
+    uint64_t epoch = resizeEpoch();
+    if (measured_at.load(std::memory_order_relaxed) != epoch) {
+        // Marked first, so a resize during the query triggers another one
+        measured_at.store(epoch, std::memory_order_relaxed);
+        cached_columns.store(queryColumns(), std::memory_order_relaxed);
+    }
+    return cached_columns.load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief Asks the terminal for its width.
+ */
+size_t FdSink::queryColumns() const {
+#ifdef _WIN32
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (!GetConsoleScreenBufferInfo(handle, &info)) {
+        return 0;
+    }
+    return static_cast<size_t>(info.srWindow.Right - info.srWindow.Left + 1);
+#else
+    struct winsize size = {};
+    if (ioctl(fd, TIOCGWINSZ, &size) != 0) {
+        return 0;
+    }
+    return size.ws_col;
+#endif
+}
+
+/**
+ * \brief Returns the number of bytes the terminal has not sent yet.
+ *
+ * Grows when the terminal, or the connection behind a pseudo-terminal such
+ * as an SSH session, cannot keep up with the output.
+ *
+ * \return The bytes in the terminal's output queue, or 0 if the descriptor
+ *         is not a terminal or the platform cannot tell.
+ */
+size_t FdSink::pendingBytes() const {
+#if !defined(_WIN32) && defined(TIOCOUTQ)
+    int queued = 0;
+    if (terminal && ioctl(fd, TIOCOUTQ, &queued) == 0 && queued > 0) {
+        return static_cast<size_t>(queued);
+    }
+#endif
+    return 0;
+}
+
+/**
+ * \brief Writes a frame to the descriptor in one call.
+ *
+ * The call is only repeated for interrupted or partial writes. Output
+ * errors are ignored, since progress output is best effort.
+ *
+ * \param data The bytes to write.
+ * \param size Number of bytes to write.
+ * \return Always true; this sink never drops frames.
+ */
+bool FdSink::write(const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        int written = ::_write(fd, data, static_cast<unsigned int>(size));
+        if (written < 0) {
+            break;
+        }
+#else
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+#endif
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * \brief Constructor for MemorySink.
+ *
+ * \param terminal Whether indicators should treat the sink as a terminal and
+ *                 draw in place, or log plain lines.
+ * \param columns Terminal width to report, or 0 for an unlimited width.
+ */
+MemorySink::MemorySink(bool terminal, size_t columns)
+    : terminal(terminal), terminal_columns(columns), pending_bytes(0) {}
+
+/**
+ * \brief Appends a frame to the buffer.
+ *
+ * \return Always true.
+ */
+bool MemorySink::write(const char* data, size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.append(data, size);
+    return true;
+}
+
+/**
+ * \brief Returns a copy of everything written since the last clear().
+ */
+std::string MemorySink::contents() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffer;
+}
+
+/**
+ * \brief Discards the collected output.
+ */
+void MemorySink::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.clear();
+}
+
+/**
+ * \brief Constructor for AsyncSink.
+ *
+ * Starts the writer thread.
+ *
+ * \param target The sink the writer thread writes to.
+ * \param slots Number of frames that can be queued; rounded up to a power
+ *              of two, at least 2.
+ */
+AsyncSink::AsyncSink(std::shared_ptr<OutputSink> target, size_t slots)
+    : target(std::move(target)),
+      enqueue_pos(0),
+      dequeue_pos(0),
+      dropped(0),
+      queued_bytes(0),
+      sleeping(false),
+      written(0),
+      running(true) {
+    size_t size = 2;
+    while (size < slots) {
+        size *= 2;
+    }
+    ring = std::vector<Slot>(size);
+    mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+        ring[i].frame.reserve(4096);
+    }
+    writer_thread = std::thread(&AsyncSink::run, this);
+}
+
+/**
+ * \brief Destructor for AsyncSink.
+ *
+ * Writes the frames still queued and stops the writer thread.
+ */
+AsyncSink::~AsyncSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+}
+
+/**
+ * \brief Queues a frame for the writer thread.
+ *
+ * Never blocks on the target. The only lock taken is the one needed to wake
+ * a sleeping writer, which is never held across I/O.
+ *
+ * \param data The bytes to write.
+ * \param size Number of bytes to write.
+ * \return false if the ring was full and the frame was dropped.
+ */
+bool AsyncSink::write(const char* data, size_t size) {
+    size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &ring[pos & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        if (sequence == pos) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (sequence < pos) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->frame.assign(data, size);
+    queued_bytes.fetch_add(size, std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_seq_cst);
+
+    if (sleeping.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake.notify_one();
+    }
+    return true;
+}
+
+/**
+ * \brief Waits until every frame queued so far has been written.
+ *
+ * Used before final frames, which must not be dropped.
+ */
+void AsyncSink::flush() {
+    size_t queued = enqueue_pos.load(std::memory_order_acquire);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this, queued]() { return written >= queued; });
+    }
+    target->flush();
+}
+
+/**
+ * \brief Takes the oldest queued frame, if it is ready.
+ *
+ * Only called by the writer thread. The slot's buffer is swapped with
+ * frame, so both keep their capacity and no allocation happens.
+ *
+ * \param frame Receives the frame.
+ * \return false if no frame is ready.
+ */
+bool AsyncSink::pop(std::string& frame) {
+    Slot& slot = ring[dequeue_pos & mask];
+    if (slot.sequence.load(std::memory_order_seq_cst) != dequeue_pos + 1) {
+        return false;
+    }
+    frame.swap(slot.frame);
+    slot.sequence.store(dequeue_pos + ring.size(), std::memory_order_release);
+    ++dequeue_pos;
+    return true;
+}
+
+/**
+ * \brief Body of the writer thread.
+ *
+ * Writes queued frames in order and sleeps while the ring is empty. Queued
+ * frames are still written after the sink has been asked to stop.
+ */
+void AsyncSink::run() {
+    std::string frame;
+    frame.reserve(4096);
+    for (;;) {
+        if (pop(frame)) {
+            target->write(frame.data(), frame.size());
+            queued_bytes.fetch_sub(frame.size(), std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex);
+            ++written;
+            drained.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true, std::memory_order_seq_cst);
+        Slot& next = ring[dequeue_pos & mask];
+        if (next.sequence.load(std::memory_order_seq_cst) != dequeue_pos + 1) {
+            if (!running) {
+                break;
+            }
+            wake.wait(lock);
+        }
+        sleeping.store(false, std::memory_order_relaxed);
+    }
+}
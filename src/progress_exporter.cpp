@@ -0,0 +1,483 @@
+#include "progress_spinner/progress_exporter.hpp"
+#include "progress_spinner/progress_indicator.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * \brief Appends text to out as a JSON string, quotes included.
+ *
+ * UTF-8 is passed through; quotes, backslashes and control characters are
+ * escaped.
+ */
+void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (byte < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", byte);
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+/**
+ * \brief Appends value with the given number of decimals, or null if it is
+ * negative, i.e. unknown.
+ */
+void appendNumber(std::string& out, double value, int decimals) {
+    if (value < 0.0) {
+        out += "null";
+        return;
+    }
+    char number[32];
+    std::snprintf(number, sizeof(number), "%.*f", decimals, value);
+    out += number;
+}
+
+/**
+ * \brief Appends one snapshot as a line of JSON.
+ */
+void appendSnapshotLine(std::string& out, double time, uint64_t sequence, const ProgressSnapshot& snapshot) {
+    out += "{\"time\":";
+    appendNumber(out, time, 3);
+    out += ",\"snapshot\":";
+    out += std::to_string(sequence);
+    out += ",\"id\":";
+    out += std::to_string(snapshot.id);
+    out += ",\"label\":";
+    appendJsonString(out, snapshot.label);
+    out += ",\"state\":\"";
+    out += ProgressSnapshot::stateName(snapshot.state);
+    out += "\",\"done\":";
+    out += std::to_string(snapshot.done);
+    out += ",\"total\":";
+    out += std::to_string(snapshot.total);
+    out += ",\"percent\":";
+    appendNumber(out, snapshot.percentage, 1);
+    out += ",\"rate\":";
+    appendNumber(out, snapshot.rate, 1);
+    out += ",\"eta\":";
+    appendNumber(out, snapshot.eta_seconds, 1);
+    out += "}\n";
+}
+
+} // namespace
+
+/**
+ * \brief Returns the name of state as used in exported snapshots.
+ */
+const char* ProgressSnapshot::stateName(State state) {
+    switch (state) {
+    case State::Running:
+        return "running";
+    case State::Paused:
+        return "paused";
+    case State::Hidden:
+        return "hidden";
+    case State::Done:
+        return "done";
+    }
+    return "unknown";
+}
+
+/**
+ * \brief Export to an open file descriptor, e.g. a log file or a pipe.
+ *
+ * The descriptor is not closed by the exporter. While the exporter runs,
+ * the descriptor is non-blocking, so it should not be shared with the
+ * terminal output; snapshots it has no room for are dropped. stop()
+ * restores its flags and writes the last snapshot in full. On Windows,
+ * writes block.
+ */
+ExportTarget ExportTarget::fileDescriptor(int fd) {
+    return ExportTarget{Kind::Fd, fd, std::string()};
+}
+
+/**
+ * \brief Export to the Unix domain stream socket listening at path.
+ *
+ * The exporter connects when it starts and reconnects after errors.
+ * Snapshots the listener does not take in time are dropped.
+ */
+ExportTarget ExportTarget::unixSocket(const std::string& path) {
+    return ExportTarget{Kind::UnixSocket, -1, path};
+}
+
+/**
+ * \brief Export to a file that always holds the latest snapshot.
+ *
+ * Each snapshot is written to path + ".tmp" and renamed over path, by a
+ * thread of the exporter. If the file system is slower than the export
+ * interval, snapshots in between are skipped.
+ */
+ExportTarget ExportTarget::textfile(const std::string& path) {
+    return ExportTarget{Kind::Textfile, -1, path};
+}
+
+/**
+ * \brief Constructor for ProgressExporter.
+ *
+ * \param target Where to write the snapshots.
+ * \param options How often to take a snapshot.
+ * \throws std::invalid_argument if the target has no path or an invalid
+ *         descriptor, and std::runtime_error for Unix sockets on Windows.
+ */
+ProgressExporter::ProgressExporter(const ExportTarget& target, const ProgressExporterOptions& options)
+    : target(target),
+      interval_ms(options.export_interval_ms),
+      socket_fd(-1),
+      fd_flags(-1),
+      sequence(0),
+      running(false),
+      written(0),
+      dropped(0),
+      textfile_pending(false),
+      textfile_running(false) {
+    if (target.kind == ExportTarget::Kind::Fd && target.fd < 0) {
+        throw std::invalid_argument("ProgressExporter: invalid file descriptor " + std::to_string(target.fd));
+    }
+    if (target.kind != ExportTarget::Kind::Fd && target.path.empty()) {
+        throw std::invalid_argument("ProgressExporter: the target path cannot be empty");
+    }
+#ifdef _WIN32
+    if (target.kind == ExportTarget::Kind::UnixSocket) {
+        throw std::runtime_error("ProgressExporter: Unix sockets are not supported on Windows");
+    }
+#else
+    if (target.kind == ExportTarget::Kind::UnixSocket && target.path.size() >= sizeof(sockaddr_un::sun_path)) {
+        throw std::invalid_argument("ProgressExporter: socket path too long: " + target.path);
+    }
+#endif
+    buffer.reserve(4096);
+}
+
+/**
+ * \brief Destructor for ProgressExporter; stops it, writing a last snapshot.
+ */
+ProgressExporter::~ProgressExporter() {
+    stop();
+}
+
+/**
+ * \brief Starts taking snapshots at the export interval.
+ *
+ * Makes a descriptor target non-blocking and starts the writer thread of a
+ * textfile target.
+ */
+void ProgressExporter::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return;
+        }
+        running = true;
+#ifndef _WIN32
+        if (target.kind == ExportTarget::Kind::Fd) {
+            fd_flags = fcntl(target.fd, F_GETFL);
+            if (fd_flags >= 0) {
+                fcntl(target.fd, F_SETFL, fd_flags | O_NONBLOCK);
+            }
+        }
+#endif
+    }
+    if (target.kind == ExportTarget::Kind::Textfile) {
+        textfile_running = true;
+        textfile_thread = std::thread(&ProgressExporter::runTextfileWriter, this);
+    }
+    RenderScheduler::instance().add(this, std::chrono::milliseconds(interval_ms));
+}
+
+/**
+ * \brief Stops taking snapshots.
+ *
+ * A last snapshot is written first, so the final state of indicators
+ * stopped just before is not lost. This runs on the calling thread, which
+ * waits until the last snapshot has been written in full.
+ */
+void ProgressExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    RenderScheduler::instance().remove(this);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+#ifndef _WIN32
+        if (fd_flags >= 0) {
+            fcntl(target.fd, F_SETFL, fd_flags);
+            fd_flags = -1;
+        }
+#endif
+        exportSnapshot();
+#ifndef _WIN32
+        if (socket_fd >= 0) {
+            close(socket_fd);
+            socket_fd = -1;
+        }
+#endif
+    }
+
+    if (textfile_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(textfile_mutex);
+            textfile_running = false;
+        }
+        textfile_wake.notify_one();
+        textfile_thread.join();
+    }
+}
+
+/**
+ * \brief Scheduler callback: writes a snapshot to the target.
+ *
+ * Nothing is added to the terminal frame.
+ */
+void ProgressExporter::renderFrame(std::string& frame) {
+    (void)frame;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) {
+        exportSnapshot();
+    }
+}
+
+/**
+ * \brief Collects one line per live indicator and delivers them.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressExporter::exportSnapshot() {
+    double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    ++sequence;
+    buffer.clear();
+    for (const ProgressSnapshot& snapshot : ProgressIndicator::snapshotAll()) {
+        appendSnapshotLine(buffer, now, sequence, snapshot);
+    }
+    if (target.kind == ExportTarget::Kind::Textfile) {
+        queueTextfile();
+        return;
+    }
+    if (deliver()) {
+        written.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief Writes the buffer to a descriptor or socket target.
+ *
+ * \return false if the snapshot was dropped.
+ */
+bool ProgressExporter::deliver() {
+    if (target.kind == ExportTarget::Kind::UnixSocket) {
+        return sendToSocket();
+    }
+    return writeToFd();
+}
+
+/**
+ * \brief Writes the buffer to the descriptor as far as it has room.
+ *
+ * The tail of a snapshot the descriptor took only in part is kept and
+ * written first the next time, so every line arrives whole. A snapshot is
+ * dropped if the descriptor has no room at all, or is still busy with such
+ * a tail.
+ *
+ * \return false if the snapshot was dropped.
+ * \note The caller must hold the mutex.
+ */
+bool ProgressExporter::writeToFd() {
+    auto writeAvailable = [this](const std::string& data, size_t offset) {
+        while (offset < data.size()) {
+#ifdef _WIN32
+            int count = ::_write(target.fd, data.data() + offset, static_cast<unsigned int>(data.size() - offset));
+#else
+            ssize_t count = ::write(target.fd, data.data() + offset, data.size() - offset);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+#endif
+            if (count <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(count);
+        }
+        return offset;
+    };
+
+    if (!unsent.empty()) {
+        unsent.erase(0, writeAvailable(unsent, 0));
+        if (!unsent.empty()) {
+            return false;
+        }
+    }
+    size_t count = writeAvailable(buffer, 0);
+    if (count == 0 && !buffer.empty()) {
+        return false;
+    }
+    unsent.assign(buffer, count, std::string::npos);
+    return true;
+}
+
+/**
+ * \brief Sends the buffer to the socket without blocking, connecting first
+ * if needed.
+ *
+ * A snapshot is only sent whole: if the listener has no room for it, it is
+ * dropped. On errors the connection is closed and tried again with the
+ * next snapshot.
+ *
+ * \return false if the snapshot was dropped.
+ */
+bool ProgressExporter::sendToSocket() {
+#ifdef _WIN32
+    return false;
+#else
+    if (socket_fd < 0) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return false;
+        }
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, target.path.c_str(), target.path.size() + 1);
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return false;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        socket_fd = fd;
+    }
+
+    int flags = 0;
+#ifdef MSG_NOSIGNAL
+    flags |= MSG_NOSIGNAL;
+#endif
+    const char* data = buffer.data();
+    size_t size = buffer.size();
+    bool started = false;
+    while (size > 0) {
+        ssize_t count = send(socket_fd, data, size, flags);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && !started) {
+                return false;
+            }
+            // Broken connection, or a line cut in half; start over
+            close(socket_fd);
+            socket_fd = -1;
+            return false;
+        }
+        started = true;
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+#endif
+}
+
+/**
+ * \brief Hands the buffer to the textfile writer thread.
+ *
+ * A snapshot the writer has not taken yet is replaced, and counted as
+ * dropped.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressExporter::queueTextfile() {
+    {
+        std::lock_guard<std::mutex> lock(textfile_mutex);
+        if (textfile_pending) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        textfile_snapshot.swap(buffer);
+        textfile_pending = true;
+    }
+    textfile_wake.notify_one();
+}
+
+/**
+ * \brief Body of the textfile writer thread.
+ *
+ * Writes the latest snapshot whenever there is a new one. A snapshot still
+ * queued when the exporter stops is written before the thread exits.
+ */
+void ProgressExporter::runTextfileWriter() {
+    std::string snapshot;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(textfile_mutex);
+            textfile_wake.wait(lock, [this]() { return textfile_pending || !textfile_running; });
+            if (!textfile_pending) {
+                return;
+            }
+            snapshot.swap(textfile_snapshot);
+            textfile_pending = false;
+        }
+        if (replaceTextfile(snapshot)) {
+            written.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * \brief Writes a snapshot to a temporary file and renames it over the
+ * textfile, so readers see either the old or the new snapshot.
+ *
+ * Only called by the textfile writer thread.
+ *
+ * \return false if the file could not be written.
+ */
+bool ProgressExporter::replaceTextfile(const std::string& snapshot) {
+    std::string temporary = target.path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool complete = std::fwrite(snapshot.data(), 1, snapshot.size(), file) == snapshot.size();
+    complete = std::fclose(file) == 0 && complete;
+    if (!complete) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    return MoveFileExA(temporary.c_str(), target.path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return std::rename(temporary.c_str(), target.path.c_str()) == 0;
+#endif
+}
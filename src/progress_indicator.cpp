@@ -1,4 +1,52 @@
 #include "progress_spinner/progress_indicator.hpp"
+#include "progress_spinner/text_width.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/**
+ * \brief Every started indicator in the process, for exporters.
+ *
+ * Allocated once and never destroyed, like the console sink, so indicators
+ * destroyed during static destruction still find it.
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<ProgressIndicator*> indicators;
+    // Final snapshots of stopped indicators that still exist
+    std::vector<ProgressSnapshot> retired;
+    uint64_t next_id = 1;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+/**
+ * \brief Forgets the final snapshot of the indicator with the given id.
+ *
+ * \note The caller must hold the registry mutex.
+ */
+void eraseRetired(Registry& live, uint64_t id) {
+    live.retired.erase(std::remove_if(live.retired.begin(), live.retired.end(),
+                                      [id](const ProgressSnapshot& snapshot) { return snapshot.id == id; }),
+                       live.retired.end());
+}
+
+// Pacing base of immediate-mode indicators, which have no interval of their own
+constexpr std::chrono::microseconds immediate_interval(16667);
+
+} // namespace
+
+thread_local bool ProgressIndicator::constructing_managed = false;
+
+// Dumping at stop() can be switched on without recompiling
+std::atomic<bool> ProgressIndicator::stats_on_stop(std::getenv("PROGRESS_INDICATOR_STATS") != nullptr);
 
 /**
  * \brief Constructor for ProgressIndicator.
@@ -10,7 +58,152 @@ ProgressIndicator::ProgressIndicator(const std::string& progress_label,
                                      const std::string& completed_label)
     : progress_label(progress_label),
       completed_label(completed_label),
-      console() {}
+      console(),
+      managed(constructing_managed),
+      dirty(false),
+      label_generation(1),
+      source_label_generation(0),
+      indicator_id(0),
+      scheduled(false),
+      paused(false),
+      hidden(false),
+      render_interval(0),
+      last_write(),
+      rendered_bytes(0),
+      label_width(0),
+      measured_generation(0),
+      completed_width(displayWidth(completed_label)),
+      fitted_generation(0),
+      fitted_available(0) {
+    // Sized so that typical frames never reallocate while drawing
+    line.reserve(256);
+    frame_buffer.reserve(256);
+    // Text printed before the indicator must not be overtaken by its frames
+    if (!managed) {
+        console.flush();
+    }
+
+    Registry& live = registry();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    indicator_id = live.next_id++;
+}
+
+/**
+ * \brief Destructor for ProgressIndicator.
+ *
+ * Forgets the final snapshot of the indicator. Derived classes that
+ * registered must have unregistered before their own members were
+ * destroyed.
+ */
+ProgressIndicator::~ProgressIndicator() {
+    unregisterIndicator();
+}
+
+/**
+ * \brief Adds this indicator to those snapshotAll() reports.
+ *
+ * Snapshots call into the indicator from other threads, so derived classes
+ * register only once fully built, at the end of start(). A class that
+ * registers must call retireIndicator() in stop() and unregisterIndicator()
+ * first thing in its destructor; indicators that never register are simply
+ * not exported. Registering again after stop() replaces the final
+ * snapshot. Called without the mutex held.
+ */
+void ProgressIndicator::registerIndicator() {
+    Registry& live = registry();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    eraseRetired(live, indicator_id);
+    if (std::find(live.indicators.begin(), live.indicators.end(), this) == live.indicators.end()) {
+        live.indicators.push_back(this);
+    }
+}
+
+/**
+ * \brief Replaces this indicator by its final snapshot, marked done.
+ *
+ * Called at the end of stop(), without the mutex held. Exporters keep
+ * reporting the final state until the indicator is destroyed or started
+ * again, without calling into it any more.
+ */
+void ProgressIndicator::retireIndicator() {
+    ProgressSnapshot final_state = snapshot();
+    final_state.state = ProgressSnapshot::State::Done;
+    Registry& live = registry();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    auto it = std::find(live.indicators.begin(), live.indicators.end(), this);
+    if (it == live.indicators.end()) {
+        return;
+    }
+    live.indicators.erase(it);
+    live.retired.push_back(std::move(final_state));
+}
+
+/**
+ * \brief Removes this indicator and its final snapshot from those
+ * snapshotAll() reports.
+ *
+ * Called without the mutex held. Once this returns, no exporter calls into
+ * the indicator any more.
+ */
+void ProgressIndicator::unregisterIndicator() {
+    Registry& live = registry();
+    std::lock_guard<std::mutex> lock(live.mutex);
+    live.indicators.erase(std::remove(live.indicators.begin(), live.indicators.end(), this),
+                          live.indicators.end());
+    eraseRetired(live, indicator_id);
+}
+
+/**
+ * \brief Returns the state of every started indicator, and the final state
+ * of every stopped one that still exists, in the order they were created.
+ */
+std::vector<ProgressSnapshot> ProgressIndicator::snapshotAll() {
+    std::vector<ProgressSnapshot> snapshots;
+    {
+        Registry& live = registry();
+        std::lock_guard<std::mutex> lock(live.mutex);
+        snapshots.reserve(live.indicators.size() + live.retired.size());
+        for (ProgressIndicator* indicator : live.indicators) {
+            snapshots.push_back(indicator->snapshot());
+        }
+        snapshots.insert(snapshots.end(), live.retired.begin(), live.retired.end());
+    }
+    std::sort(snapshots.begin(), snapshots.end(),
+              [](const ProgressSnapshot& a, const ProgressSnapshot& b) { return a.id < b.id; });
+    return snapshots;
+}
+
+/**
+ * \brief Returns the current state of the indicator, e.g. for export.
+ *
+ * Takes the mutex briefly; producers that only store their progress are not
+ * affected.
+ */
+ProgressSnapshot ProgressIndicator::snapshot() {
+    ProgressSnapshot snapshot;
+    TimedLock lock(mutex, counters);
+    fillSnapshot(snapshot);
+    return snapshot;
+}
+
+/**
+ * \brief Fills in what every indicator knows: id, label, state and the
+ * percentage shown.
+ *
+ * Derived classes add their counts and mark themselves done.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::fillSnapshot(ProgressSnapshot& snapshot) {
+    snapshot.id = indicator_id;
+    snapshot.label = progress_label;
+    snapshot.percentage = shownPercentage();
+    if (hidden) {
+        snapshot.state = ProgressSnapshot::State::Hidden;
+    } else if (paused) {
+        snapshot.state = ProgressSnapshot::State::Paused;
+    }
+}
 
 /**
  * \brief Updates the label displayed by the progress indicator.
@@ -18,16 +211,123 @@ ProgressIndicator::ProgressIndicator(const std::string& progress_label,
  * \param new_text The new label string.
  */
 void ProgressIndicator::updateText(const std::string& new_text) {
-    std::lock_guard<std::mutex> lock(mutex);
-    progress_label = new_text;
+    counters.countUpdate();
+    TimedLock lock(mutex, counters);
+    setLabel(new_text);
+    dirty = true;
+}
+
+/**
+ * \brief Freezes the indicator on screen.
+ *
+ * The indicator leaves the render scheduler, so it causes no wakeups at all
+ * while paused, and updates only change its state. Managed indicators are
+ * drawn by their MultiProgress and are not affected.
+ */
+void ProgressIndicator::pause() {
+    {
+        TimedLock lock(mutex, counters);
+        if (paused) {
+            return;
+        }
+        paused = true;
+    }
+    updateSchedule();
+}
+
+/**
+ * \brief Undoes pause() and draws the current state right away.
+ */
+void ProgressIndicator::resume() {
+    {
+        TimedLock lock(mutex, counters);
+        if (!paused) {
+            return;
+        }
+        paused = false;
+    }
+    updateSchedule();
+    redrawNow();
+}
+
+/**
+ * \brief Removes the indicator from the screen, or brings it back.
+ *
+ * A hidden indicator clears its line and, like a paused one, is not woken
+ * up until it is shown again. stop() always shows the final line.
+ *
+ * \param hide true to hide the indicator, false to show it again.
+ */
+void ProgressIndicator::setHidden(bool hide) {
+    {
+        TimedLock lock(mutex, counters);
+        if (hidden == hide) {
+            return;
+        }
+        hidden = hide;
+        if (hide && !managed && console.isTerminal()) {
+            FrameSpan span{indicator_id, 4};
+            console.writeFrame("\r\033[K", 4, &span, 1);
+            screen_line.invalidate();
+        }
+    }
+    updateSchedule();
+    if (!hide) {
+        redrawNow();
+    }
+}
+
+/**
+ * \brief Returns the self-instrumentation counters of this indicator.
+ *
+ * Safe to call from any thread at any time, also while the indicator is
+ * being updated and drawn.
+ */
+IndicatorStats ProgressIndicator::stats() const {
+    return counters.snapshot();
+}
+
+/**
+ * \brief Enables or disables printing the counters of every indicator to
+ * stderr when it is stopped.
+ *
+ * Disabled by default, unless the PROGRESS_INDICATOR_STATS environment
+ * variable is set.
+ *
+ * \param enabled true to print the counters at stop().
+ */
+void ProgressIndicator::setStatsOnStop(bool enabled) {
+    stats_on_stop.store(enabled, std::memory_order_relaxed);
+}
+
+/**
+ * \brief Prints the counters to stderr if enabled with setStatsOnStop().
+ *
+ * Called at the end of stop(), without the mutex held.
+ */
+void ProgressIndicator::dumpStats() {
+    if (!stats_on_stop.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::string label;
+    {
+        TimedLock lock(mutex, counters);
+        label = progress_label;
+    }
+    std::fprintf(stderr, "progress stats: label=\"%s\" %s\n", label.c_str(), stats().toString().c_str());
 }
 
 /**
  * \brief Controls the visibility of the cursor.
  *
+ * Managed indicators leave the cursor to their MultiProgress.
+ *
  * \param show_flag true to show the cursor, false to hide it.
  */
 void ProgressIndicator::showCursor(bool show_flag) {
+    if (managed) {
+        return;
+    }
     console.showCursor(show_flag);
 }
 
@@ -40,3 +340,430 @@ void ProgressIndicator::showCursor(bool show_flag) {
 void ProgressIndicator::clearLine() {
     console.clearLine();
 }
+
+/**
+ * \brief Replaces the label and invalidates everything measured from it.
+ *
+ * \param new_label The new label string.
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::setLabel(const std::string& new_label) {
+    progress_label = new_label;
+    ++label_generation;
+}
+
+/**
+ * \brief Takes over the label of a source that publishes one, such as a
+ * SharedProgress slot, when it changed.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::adoptSourceLabel(const ProgressSource& source) {
+    if (source.label(source_label_generation, source_label)) {
+        setLabel(source_label);
+        dirty = true;
+    }
+}
+
+/**
+ * \brief Returns the display width of the label, measured once per label.
+ *
+ * \note The caller must hold the mutex.
+ */
+size_t ProgressIndicator::labelWidth() {
+    if (measured_generation != label_generation) {
+        label_width = displayWidth(progress_label);
+        measured_generation = label_generation;
+    }
+    return label_width;
+}
+
+/**
+ * \brief Returns the label, shortened if needed so that it and reserved
+ * more cells fit on one terminal line.
+ *
+ * The last column is left free, since some terminals wrap as soon as it is
+ * written. A shortened label ends in an ellipsis and is cached until the
+ * label or the space left for it changes.
+ *
+ * \param columns Terminal width, or 0 for no limit.
+ * \param reserved Cells needed by the rest of the line.
+ * \note The caller must hold the mutex.
+ */
+const std::string& ProgressIndicator::fittedLabel(size_t columns, size_t reserved) {
+    if (columns == 0) {
+        return progress_label;
+    }
+    size_t available = columns > reserved + 1 ? columns - reserved - 1 : 0;
+    if (labelWidth() <= available) {
+        return progress_label;
+    }
+    if (fitted_generation != label_generation || fitted_available != available) {
+        fitted_label = ellipsize(progress_label, available);
+        fitted_generation = label_generation;
+        fitted_available = available;
+    }
+    return fitted_label;
+}
+
+/**
+ * \brief Composes the current line and appends what changed on screen.
+ *
+ * Only the cells that differ from the last emitted line are written, so a
+ * frame without visible change appends nothing. Without a terminal, a plain
+ * line is appended instead, and only when the log policy says one is due.
+ *
+ * \param frame The frame buffer to append to.
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::composeFrame(std::string& frame) {
+    frame_started = IndicatorCounters::Clock::now();
+    size_t frame_size = frame.size();
+    line.clear();
+    composeLine(line);
+    if (console.isTerminal()) {
+        screen_line.update(line, frame);
+    } else {
+        log_line.update(line, shownPercentage(), frame);
+    }
+    countEmptyFrame(frame.size() - frame_size);
+}
+
+/**
+ * \brief Composes the current line and writes it from the calling thread.
+ *
+ * Used by immediate-mode updates; the sink is loaded once for the frame.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::drawFrame() {
+    IConsole::FrameScope scope;
+    frame_buffer.clear();
+    composeFrame(frame_buffer);
+    writeFrame(frame_buffer);
+}
+
+/**
+ * \brief Composes the final line and leaves the cursor below it.
+ *
+ * The next frame starts on a fresh line. Without a terminal, the final line
+ * is always logged unless it is identical to the last one.
+ *
+ * \param frame The frame buffer to append to.
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::composeFinalFrame(std::string& frame) {
+    frame_started = IndicatorCounters::Clock::now();
+    size_t frame_size = frame.size();
+    line.clear();
+    composeLine(line);
+    if (console.isTerminal()) {
+        screen_line.update(line, frame);
+        frame += '\n';
+        screen_line.invalidate();
+    } else {
+        log_line.finish(line, frame);
+    }
+    countEmptyFrame(frame.size() - frame_size);
+}
+
+/**
+ * \brief Counts a composed frame that turned out empty as skipped.
+ *
+ * Frames with content are only counted once they reach the sink, in
+ * deliverFrame() or frameWritten(), so that frames of managed indicators and
+ * dropped frames are not counted as output.
+ *
+ * \param bytes Number of bytes the frame added.
+ */
+void ProgressIndicator::countEmptyFrame(size_t bytes) {
+    if (bytes == 0) {
+        counters.countSkipped();
+    }
+}
+
+/**
+ * \brief Writes a composed frame to the console in a single write.
+ *
+ * Managed indicators never write; their MultiProgress draws them instead.
+ * Empty frames are not written at all. Frames of a paused or hidden
+ * indicator are discarded, and so are immediate-mode frames beyond the
+ * paced rate while the output is backed up. If the sink drops the frame,
+ * the next frame redraws the whole line.
+ *
+ * \param frame The bytes to write, including any control sequences.
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::writeFrame(const std::string& frame) {
+    if (managed || frame.empty()) {
+        return;
+    }
+    if (paused || hidden || throttled()) {
+        discardFrame();
+        return;
+    }
+    deliverFrame(frame);
+}
+
+/**
+ * \brief Writes a frame that must not be dropped, such as the final line.
+ *
+ * Waits for the sink to catch up first, so an asynchronous sink has room
+ * for the frame. The frame is written even if the indicator is paused or
+ * hidden, which it no longer is afterwards, or the output is backed up.
+ *
+ * \param frame The bytes to write, including any control sequences.
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::writeFinalFrame(const std::string& frame) {
+    paused = false;
+    hidden = false;
+    if (managed || frame.empty()) {
+        return;
+    }
+    console.flush();
+    deliverFrame(frame);
+}
+
+/**
+ * \brief Writes a frame and tells the pacer how the write went.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::deliverFrame(const std::string& frame) {
+    IndicatorCounters::Clock::time_point write_started = IndicatorCounters::Clock::now();
+    FrameSpan span{indicator_id, frame.size()};
+    if (!console.writeFrame(frame.data(), frame.size(), &span, 1)) {
+        discardFrame();
+        return;
+    }
+    last_write = IndicatorCounters::Clock::now();
+    counters.countFrame(frame.size());
+    FramePacer& pacer = RenderScheduler::instance().pacer();
+    IndicatorCounters::Clock::duration took = last_write - write_started;
+    pacer.recordWrite(took, pacer.backlogDue(took) ? console.pendingBytes() : 0);
+    counters.countLatency(last_write - frame_started);
+}
+
+/**
+ * \brief Checks whether an immediate-mode frame must be skipped because the
+ * output is backed up.
+ *
+ * While the pacer slows the output down, immediate-mode indicators draw at
+ * most at the paced rate; the next update after that draws the current
+ * state. Scheduled indicators are paced by the scheduler instead, and log
+ * lines are never skipped.
+ *
+ * \note The caller must hold the mutex.
+ */
+bool ProgressIndicator::throttled() const {
+    if (render_interval.count() > 0 || !console.isTerminal()) {
+        return false;
+    }
+    const FramePacer& pacer = RenderScheduler::instance().pacer();
+    if (pacer.slowdown() <= 1.0) {
+        return false;
+    }
+    return IndicatorCounters::Clock::now() - last_write < pacer.pace(immediate_interval);
+}
+
+/**
+ * \brief Returns the rate this indicator is drawn at right now.
+ *
+ * Lower than the configured rate while the output is backed up, see
+ * FramePacer.
+ *
+ * \return The rate in Hz. Immediate-mode indicators report infinity while
+ *         they draw every change, and managed indicators report 0, since
+ *         their MultiProgress draws them.
+ */
+double ProgressIndicator::frameRateHz() {
+    if (managed) {
+        return 0.0;
+    }
+    std::chrono::microseconds interval;
+    {
+        TimedLock lock(mutex, counters);
+        interval = render_interval;
+    }
+    const FramePacer& pacer = RenderScheduler::instance().pacer();
+    if (interval.count() > 0) {
+        return pacer.rateHz(interval);
+    }
+    if (pacer.slowdown() > 1.0) {
+        return pacer.rateHz(immediate_interval);
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+/**
+ * \brief Registers this indicator with the shared RenderScheduler.
+ *
+ * From then on renderFrame() is called on the scheduler thread once per
+ * interval, except while the indicator is paused or hidden. Derived classes
+ * use this for deferred rendering, where updates only store the new state
+ * and the frame decides whether a redraw is needed. Managed indicators are
+ * not registered, since their MultiProgress is.
+ *
+ * \param interval Time between two frames.
+ */
+void ProgressIndicator::startRenderer(std::chrono::microseconds interval) {
+    if (managed) {
+        return;
+    }
+    {
+        TimedLock lock(mutex, counters);
+        render_interval = interval;
+    }
+    updateSchedule();
+}
+
+/**
+ * \brief Unregisters this indicator from the RenderScheduler.
+ *
+ * Derived classes must call this before their own members are destroyed,
+ * and without holding the mutex, since the scheduler calls back into
+ * renderFrame().
+ */
+void ProgressIndicator::stopRenderer() {
+    {
+        TimedLock lock(mutex, counters);
+        render_interval = std::chrono::microseconds(0);
+    }
+    updateSchedule();
+}
+
+/**
+ * \brief Adds this indicator to the scheduler or removes it, depending on
+ * whether it has a renderer and is neither paused nor hidden.
+ *
+ * Called without the mutex held, from the thread that controls the
+ * indicator.
+ */
+void ProgressIndicator::updateSchedule() {
+    std::chrono::microseconds interval(0);
+    {
+        TimedLock lock(mutex, counters);
+        if (!paused && !hidden) {
+            interval = render_interval;
+        }
+    }
+    if (interval.count() > 0) {
+        scheduled = true;
+        RenderScheduler::instance().add(this, interval);
+    } else if (scheduled) {
+        scheduled = false;
+        RenderScheduler::instance().remove(this);
+    }
+}
+
+/**
+ * \brief Draws the current state from the calling thread.
+ *
+ * Used after resume() and when shown again, so the indicator does not wait
+ * for its next update or tick. Does nothing while paused or hidden.
+ */
+void ProgressIndicator::redrawNow() {
+    if (managed) {
+        return;
+    }
+    TimedLock lock(mutex, counters);
+    if (paused || hidden) {
+        return;
+    }
+    IConsole::FrameScope scope;
+    dirty = true;
+    frame_buffer.clear();
+    if (refresh()) {
+        composeRefreshed(frame_buffer);
+    }
+    writeFrame(frame_buffer);
+}
+
+/**
+ * \brief Appends the next frame of this indicator to frame.
+ *
+ * Called by the RenderScheduler thread without the mutex held. Nothing is
+ * appended when refresh() reports no visible change.
+ *
+ * \param frame Batch buffer shared by all indicators due in this tick.
+ */
+void ProgressIndicator::renderFrame(std::string& frame) {
+    TimedLock lock(mutex, counters);
+    if (paused || hidden || !refresh()) {
+        counters.countSkipped();
+        rendered_bytes = 0;
+        return;
+    }
+    size_t frame_size = frame.size();
+    composeRefreshed(frame);
+    rendered_bytes = frame.size() - frame_size;
+}
+
+/**
+ * \brief Appends the frame for freshly refreshed state to frame.
+ *
+ * The default composes the current line; indicators that draw something
+ * else in some states override this.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressIndicator::composeRefreshed(std::string& frame) {
+    composeFrame(frame);
+}
+
+/**
+ * \brief Called by the RenderScheduler once a frame of this indicator has
+ * reached the sink.
+ *
+ * \param latency Time from when the frame was due until it was written.
+ */
+void ProgressIndicator::frameWritten(std::chrono::steady_clock::duration latency) {
+    counters.countFrame(rendered_bytes);
+    counters.countLatency(latency);
+}
+
+/**
+ * \brief Called by the RenderScheduler when the sink dropped a frame that
+ * this indicator contributed to.
+ */
+void ProgressIndicator::frameDropped() {
+    TimedLock lock(mutex, counters);
+    discardFrame();
+}
+
+/**
+ * \brief Forgets the last frame, which never reached the screen.
+ *
+ * The caller must hold the mutex. The next frame redraws the whole line.
+ */
+void ProgressIndicator::discardFrame() {
+    screen_line.invalidate();
+    dirty = true;
+}
+
+/**
+ * \brief Applies state published since the last frame.
+ *
+ * The caller must hold the mutex. The default implementation only reports
+ * pending label changes.
+ *
+ * \return true if the visible line changed and needs to be drawn again.
+ */
+bool ProgressIndicator::refresh() {
+    bool changed = dirty;
+    dirty = false;
+    return changed;
+}
+
+/**
+ * \brief Returns the progress shown by the indicator, in percent.
+ *
+ * Used to log a line at every percent step when output is not a terminal.
+ * The default implementation returns -1 for indicators without progress.
+ *
+ * \note The caller must hold the mutex.
+ */
+double ProgressIndicator::shownPercentage() const {
+    return -1.0;
+}
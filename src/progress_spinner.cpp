@@ -1,4 +1,6 @@
 #include "progress_spinner/progress_spinner.hpp"
+#include "progress_spinner/text_width.hpp"
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 
@@ -7,8 +9,8 @@
  *
  * \param options A ProgressSpinnerOptions object.
  *
- * Creates a ProgressSpinner object and starts a separate thread to update the
- * spinner animation. The spinner animation is updated every update_interval_ms
+ * Creates a ProgressSpinner object. Once started, the spinner animation is
+ * advanced by the shared RenderScheduler every update_interval_ms
  * milliseconds.
  *
  * \throws std::invalid_argument if the char_frames vector in options is
@@ -17,81 +19,130 @@
 ProgressSpinner::ProgressSpinner(const ProgressSpinnerOptions& options)
     : ProgressIndicator(options.progress_label, options.completed_label),
       chars(options.chars),
-      keep_alive(true),
+      frame_index(0),
+      glyph_width(0),
       update_interval_ms(options.update_interval_ms),
       stopped(false) {
     if (chars.empty()) {
         throw std::invalid_argument("Char frames vector may not be empty.");
     }
+    if (update_interval_ms <= 0) {
+        throw std::invalid_argument("Update interval must be greater than 0.");
+    }
+    for (const std::string& glyph : chars) {
+        glyph_width = std::max(glyph_width, displayWidth(glyph));
+    }
+    log_line = LogLine(options.log_interval_sec, 0);
 }
 
 /**
  * \brief Destructor for ProgressSpinner.
  *
- * Calls stop() to ensure that the spinner thread is joined before the object
- * is destroyed.
+ * Leaves the list of live indicators and calls stop() to ensure that the
+ * spinner is unregistered from the scheduler before the object is destroyed.
  */
 ProgressSpinner::~ProgressSpinner() {
+    unregisterIndicator();
     stop();
 }
 
 /**
- * \brief Starts the spinner animation in a separate thread.
+ * \brief Starts the spinner animation.
  *
- * Calls showCursor(false) to hide the cursor and starts a separate thread to
- * update the spinner animation. The animation is updated every
+ * Calls showCursor(false) to hide the cursor and registers the spinner with
+ * the shared RenderScheduler. The animation is updated every
  * update_interval_ms milliseconds.
  */
 void ProgressSpinner::start() {
     showCursor(false);
-    spinner_thread = std::thread(&ProgressSpinner::run, this);
+    {
+        TimedLock lock(mutex, counters);
+        started_at = std::chrono::steady_clock::now();
+        frame_index = 0;
+        dirty = true;
+    }
+    startRenderer(std::chrono::milliseconds(update_interval_ms));
+    registerIndicator();
 }
 
 /**
  * \brief Stops the spinner animation.
  *
- * Joins the spinner thread and updates the display to show the completed
- * label. Also shows the cursor again.
+ * Unregisters the spinner from the scheduler and updates the display to show
+ * the completed label. Also shows the cursor again.
  */
 void ProgressSpinner::stop() {
     {
-        std::lock_guard<std::mutex> lock(mutex);
+        TimedLock lock(mutex, counters);
         if (stopped) {
             return;
         }
         stopped = true;
-        keep_alive = false;
-    }
-    if (spinner_thread.joinable()) {
-        spinner_thread.join();
     }
+    stopRenderer();
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        clearLine();
-        std::cout << "\r" << progress_label << completed_label << std::endl;
+        TimedLock lock(mutex, counters);
+        dirty = true;
+        frame_buffer.clear();
+        composeFinalFrame(frame_buffer);
+        writeFinalFrame(frame_buffer);
         showCursor(true);
     }
+    retireIndicator();
+    dumpStats();
+}
+
+/**
+ * \brief Marks the snapshot done once the spinner has stopped.
+ *
+ * A spinner has no counts, so the percentage stays unknown.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressSpinner::fillSnapshot(ProgressSnapshot& snapshot) {
+    ProgressIndicator::fillSnapshot(snapshot);
+    if (stopped) {
+        snapshot.state = ProgressSnapshot::State::Done;
+    }
 }
 
 /**
- * \brief Function to be run in a separate thread to update the spinner animation.
+ * \brief Advances the animation to the frame for the current time.
+ *
+ * The frame is derived from the time since start() rather than counted per
+ * call, so the animation keeps its speed when a MultiProgress draws the
+ * spinner at a different rate. The caller must hold the mutex.
  *
- * The function runs an infinite loop, which is broken when the keep_alive
- * variable is set to false. The loop sleeps for update_interval_ms
- * milliseconds, then updates the display to show the next frame in the
- * spinner animation.
+ * \return true if the animation frame or the label changed.
  */
-void ProgressSpinner::run() {
-    size_t index = 0;
-    while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(update_interval_ms));
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            if (!keep_alive) {
-                break;
-            }
-            std::cout << "\r" << progress_label << chars[index] << std::flush;
+bool ProgressSpinner::refresh() {
+    if (!stopped) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started_at);
+        size_t index = static_cast<size_t>(elapsed.count() / update_interval_ms) % chars.size();
+        if (index != frame_index) {
+            frame_index = index;
+            dirty = true;
         }
-        index = (index + 1) % chars.size();
     }
+    return ProgressIndicator::refresh();
+}
+
+/**
+ * \brief Appends the visible content of the spinner to line.
+ *
+ * Shows the completed label once the spinner is stopped. On a terminal, the
+ * label is shortened with an ellipsis if the line would not fit otherwise.
+ *
+ * \note The caller must hold the mutex.
+ */
+void ProgressSpinner::composeLine(std::string& line) {
+    size_t columns = console.columns();
+    if (stopped) {
+        line += fittedLabel(columns, completedWidth());
+        line += completed_label;
+        return;
+    }
+    line += fittedLabel(columns, glyph_width);
+    line += chars[frame_index];
 }
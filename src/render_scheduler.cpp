@@ -0,0 +1,163 @@
+#include "progress_spinner/render_scheduler.hpp"
+#include <algorithm>
+
+/**
+ * \brief Returns the process-wide scheduler.
+ *
+ * The timer thread is created on first use and lives until static
+ * destruction.
+ */
+RenderScheduler& RenderScheduler::instance() {
+    static RenderScheduler scheduler;
+    return scheduler;
+}
+
+RenderScheduler::RenderScheduler() : running(true), writing(false), added(false) {
+    batch.reserve(4096);
+    rendered.reserve(16);
+    timer_thread = std::thread(&RenderScheduler::run, this);
+}
+
+/**
+ * \brief Destructor for RenderScheduler.
+ *
+ * Wakes the timer thread and waits for it to exit.
+ */
+RenderScheduler::~RenderScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (timer_thread.joinable()) {
+        timer_thread.join();
+    }
+}
+
+/**
+ * \brief Registers an indicator to be rendered every interval.
+ *
+ * The first frame is due one interval from now. Registering an indicator
+ * that is already registered only updates its interval.
+ *
+ * \param renderable The indicator to render; must stay alive until remove().
+ * \param interval Time between two frames of this indicator.
+ */
+void RenderScheduler::add(Renderable* renderable, std::chrono::microseconds interval) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Clock::time_point next_due = Clock::now() + interval;
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [renderable](const Entry& entry) { return entry.renderable == renderable; });
+        if (it != entries.end()) {
+            it->interval = interval;
+            it->next_due = next_due;
+        } else {
+            entries.push_back(Entry{renderable, interval, next_due});
+        }
+        added = true;
+    }
+    wake.notify_one();
+}
+
+/**
+ * \brief Unregisters an indicator.
+ *
+ * Once this returns the scheduler will not call into the indicator again,
+ * so it is safe to destroy it. If a frame of the indicator is being written,
+ * this waits until the write is done and the indicator has been told about
+ * it; otherwise it never waits for the output. Must not be called with the
+ * indicator's mutex held, since rendering takes that mutex.
+ *
+ * \param renderable The indicator to remove. Unknown indicators are ignored.
+ */
+void RenderScheduler::remove(Renderable* renderable) {
+    std::unique_lock<std::mutex> lock(mutex);
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [renderable](const Entry& entry) { return entry.renderable == renderable; }),
+                  entries.end());
+    if (std::this_thread::get_id() == timer_thread.get_id()) {
+        return;
+    }
+    written.wait(lock, [this, renderable] {
+        return !writing || std::none_of(rendered.begin(), rendered.end(),
+                                        [renderable](const Rendered& frame) { return frame.renderable == renderable; });
+    });
+}
+
+/**
+ * \brief Body of the timer thread.
+ *
+ * Each pass renders every indicator whose deadline has passed into one batch,
+ * writes the batch with a single write and then sleeps until the earliest
+ * remaining deadline, or indefinitely while nothing is registered. Deadlines
+ * advance by whole intervals so frame rates do not drift; an indicator that
+ * fell behind skips the missed frames instead of rendering them in a burst.
+ * The intervals are paced by how fast the previous batches were written.
+ * Every indicator that contributed to the batch is told how late its frame
+ * reached the sink, or, if the sink dropped the batch, to redraw in full.
+ *
+ * Frames are rendered under the lock, but the batch is written and the
+ * indicators are told about it with the lock released; remove() waits for
+ * that to finish before an indicator in the batch can go away.
+ */
+void RenderScheduler::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running) {
+        added = false;
+        Clock::time_point now = Clock::now();
+        Clock::time_point next_wakeup = Clock::time_point::max();
+        {
+            // One sink for the whole pass, released again before sleeping
+            IConsole::FrameScope scope;
+
+            batch.clear();
+            rendered.clear();
+            spans.clear();
+            for (Entry& entry : entries) {
+                if (entry.next_due <= now) {
+                    size_t batch_size = batch.size();
+                    entry.renderable->renderFrame(batch);
+                    if (batch.size() != batch_size) {
+                        rendered.push_back(Rendered{entry.renderable, entry.next_due});
+                        entry.renderable->frameSpans(batch.size() - batch_size, spans);
+                    }
+                    std::chrono::microseconds interval = frame_pacer.pace(entry.interval);
+                    entry.next_due += interval;
+                    if (entry.next_due <= now) {
+                        entry.next_due = now + interval;
+                    }
+                }
+                next_wakeup = std::min(next_wakeup, entry.next_due);
+            }
+
+            if (!batch.empty()) {
+                writing = true;
+                lock.unlock();
+                Clock::time_point write_started = Clock::now();
+                bool delivered = console.writeFrame(batch.data(), batch.size(), spans.data(), spans.size());
+                Clock::time_point written_at = Clock::now();
+                Clock::duration took = written_at - write_started;
+                size_t pending = frame_pacer.backlogDue(took) ? console.pendingBytes() : 0;
+                for (const Rendered& frame : rendered) {
+                    if (delivered) {
+                        frame.renderable->frameWritten(written_at - frame.due);
+                    } else {
+                        frame.renderable->frameDropped();
+                    }
+                }
+                lock.lock();
+                frame_pacer.recordWrite(took, pending);
+                writing = false;
+                written.notify_all();
+            }
+        }
+
+        auto woken = [this] { return added || !running; };
+        if (next_wakeup == Clock::time_point::max()) {
+            wake.wait(lock, woken);
+        } else {
+            wake.wait_until(lock, next_wakeup, woken);
+        }
+    }
+}
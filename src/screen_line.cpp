@@ -0,0 +1,166 @@
+#include "progress_spinner/screen_line.hpp"
+#include "progress_spinner/text_width.hpp"
+#include <algorithm>
+
+namespace {
+
+bool isContinuationByte(char byte) {
+    return (static_cast<unsigned char>(byte) & 0xC0) == 0x80;
+}
+
+size_t cellCount(const std::string& text, size_t begin, size_t end) {
+    return displayWidth(text.data() + begin, end - begin);
+}
+
+size_t digitCount(size_t value) {
+    size_t digits = 1;
+    while (value >= 10) {
+        value /= 10;
+        ++digits;
+    }
+    return digits;
+}
+
+} // namespace
+
+/**
+ * \brief Constructor for ScreenLine.
+ *
+ * A new line is invalid: the first update() clears the line and draws it in
+ * full.
+ */
+ScreenLine::ScreenLine() : shown_width(0), valid(false) {}
+
+/**
+ * \brief Appends the bytes that turn the shown line into line.
+ *
+ * The common prefix and, when the changed part keeps its width, the common
+ * suffix are skipped: the cursor is moved to the first changed cell and
+ * only the changed cells are written, followed by a clear to the end of the
+ * line if the line got shorter. Nothing is appended if line is already
+ * shown. The cursor may be anywhere on the line beforehand.
+ *
+ * \param line The new content of the line.
+ * \param frame The frame buffer to append to.
+ */
+void ScreenLine::update(const std::string& line, std::string& frame) {
+    if (!valid) {
+        frame += "\r\033[K";
+        frame += line;
+        shown = line;
+        shown_width = displayWidth(line);
+        valid = true;
+        return;
+    }
+    if (line == shown) {
+        return;
+    }
+
+    // Common prefix, backed up to the start of a code point
+    size_t limit = std::min(line.size(), shown.size());
+    size_t prefix = 0;
+    while (prefix < limit && line[prefix] == shown[prefix]) {
+        ++prefix;
+    }
+    while (prefix > 0 && ((prefix < line.size() && isContinuationByte(line[prefix])) ||
+                          (prefix < shown.size() && isContinuationByte(shown[prefix])))) {
+        --prefix;
+    }
+
+    // Common suffix after the prefix, moved forward to the start of a code point
+    size_t suffix = 0;
+    while (suffix < line.size() - prefix && suffix < shown.size() - prefix &&
+           line[line.size() - 1 - suffix] == shown[shown.size() - 1 - suffix]) {
+        ++suffix;
+    }
+    while (suffix > 0 && isContinuationByte(line[line.size() - suffix])) {
+        --suffix;
+    }
+
+    // The suffix only stays in place if the changed cells keep their width
+    size_t new_width = cellCount(line, prefix, line.size() - suffix);
+    size_t old_width = cellCount(shown, prefix, shown.size() - suffix);
+    size_t line_width = shown_width - old_width + new_width;
+    if (new_width != old_width) {
+        suffix = 0;
+    }
+
+    // Rewriting a short prefix is cheaper than moving the cursor over it
+    size_t column = cellCount(line, 0, prefix);
+    if (prefix <= 3 + digitCount(column)) {
+        prefix = 0;
+        column = 0;
+    }
+
+    frame += '\r';
+    if (column > 0) {
+        appendCursorMove(frame, column, 'C');
+    }
+    frame.append(line, prefix, line.size() - suffix - prefix);
+    if (suffix == 0 && line_width < shown_width) {
+        frame += "\033[K";
+    }
+    shown = line;
+    shown_width = line_width;
+}
+
+/**
+ * \brief Forgets the shown content.
+ *
+ * Used once the cursor has left the line, so the next update() draws a
+ * fresh line in full.
+ */
+void ScreenLine::invalidate() {
+    valid = false;
+    shown.clear();
+    shown_width = 0;
+}
+
+/**
+ * \brief Appends a relative cursor movement.
+ *
+ * \param frame The frame buffer to append to.
+ * \param count Number of cells or lines to move.
+ * \param direction 'A' (up), 'B' (down), 'C' (right) or 'D' (left).
+ */
+void ScreenLine::appendCursorMove(std::string& frame, size_t count, char direction) {
+    char digits[20];
+    size_t length = 0;
+    do {
+        digits[length++] = static_cast<char>('0' + count % 10);
+        count /= 10;
+    } while (count > 0);
+
+    frame += "\033[";
+    while (length > 0) {
+        frame += digits[--length];
+    }
+    frame += direction;
+}
+
+/**
+ * \brief Appends the cursor movement from cursor_row to row of a block of
+ * lines.
+ *
+ * Rows already on screen are reached with cursor movements; rows below the
+ * block are started with newlines.
+ *
+ * \param frame The frame buffer to append to.
+ * \param drawn_rows Number of rows of the block that are on screen.
+ * \param cursor_row Row the cursor is on; updated to row.
+ * \param row Row to move to.
+ */
+void ScreenLine::moveToRow(std::string& frame, size_t drawn_rows, size_t& cursor_row, size_t row) {
+    if (row < cursor_row) {
+        appendCursorMove(frame, cursor_row - row, 'A');
+    } else if (row > cursor_row) {
+        size_t last_line = drawn_rows > 0 ? drawn_rows - 1 : 0;
+        if (last_line > cursor_row) {
+            size_t target = std::min(row, last_line);
+            appendCursorMove(frame, target - cursor_row, 'B');
+            cursor_row = target;
+        }
+        frame.append(row - cursor_row, '\n');
+    }
+    cursor_row = row;
+}
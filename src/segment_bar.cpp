@@ -0,0 +1,151 @@
+#include "progress_spinner/segment_bar.hpp"
+#include <cmath>
+#include <mutex>
+
+/**
+ * \brief Constructor for SegmentBar.
+ *
+ * \param progress_label The initial label string.
+ * \param completed_label The string to display when the task is complete.
+ * \param refresh_rate_hz Maximum redraws per second, or 0 to redraw on every
+ *                        update.
+ * \param total_units Units of a full bar.
+ */
+SegmentBar::SegmentBar(const std::string& progress_label, const std::string& completed_label,
+                       int refresh_rate_hz, int total_units)
+    : WorkProgressIndicator(progress_label, completed_label, refresh_rate_hz),
+      total_units(total_units),
+      current_units(0),
+      finished(false) {}
+
+/**
+ * \brief Draws the empty bar and, in deferred mode, starts the renderer.
+ *
+ * From then on until stop() the bar is included in exported snapshots.
+ */
+void SegmentBar::start() {
+    {
+        TimedLock lock(mutex, counters);
+        resetWork();
+        current_units = 0;
+        finished = false;
+        dirty = true;
+        redraw();
+    }
+    startRendering();
+    registerIndicator();
+}
+
+void SegmentBar::stop() {
+    stopRenderer();
+    {
+        TimedLock lock(mutex, counters);
+        current_units = total_units;
+        finished = true;
+        dirty = true;
+
+        frame_buffer.clear();
+        composeFinalFrame(frame_buffer);
+        writeFinalFrame(frame_buffer);
+        showCursor(true);
+    }
+    retireIndicator();
+    dumpStats();
+}
+
+/**
+ * \brief Converts a percentage into a number of filled units.
+ *
+ * \param percentage Percentage value; clamped to [0, 100].
+ */
+int SegmentBar::unitsFor(double percentage) const {
+    if (percentage < 0) percentage = 0;
+    if (percentage > 100) percentage = 100;
+
+    return static_cast<int>(std::round(percentage / 100 * total_units));
+}
+
+/**
+ * \brief Changes the units of a full bar, keeping the filled part.
+ *
+ * \param new_total_units Units of a full bar; greater than 0.
+ * \note The caller must hold the mutex.
+ */
+void SegmentBar::resizeUnits(int new_total_units) {
+    double shown = shownPercentage();
+    total_units = new_total_units;
+    current_units = unitsFor(shown);
+}
+
+/**
+ * \brief Adds completion to the snapshot once the bar is stopped.
+ *
+ * \note The caller must hold the mutex.
+ */
+void SegmentBar::fillSnapshot(ProgressSnapshot& snapshot) {
+    WorkProgressIndicator::fillSnapshot(snapshot);
+    if (finished) {
+        snapshot.percentage = 100.0;
+        snapshot.state = ProgressSnapshot::State::Done;
+    }
+}
+
+/**
+ * \brief Shows the latest percentage passed to updateProgress().
+ *
+ * \note The caller must hold the mutex.
+ */
+void SegmentBar::applyProgress() {
+    readSource();
+    current_units = unitsFor(pendingPercentage());
+    redraw();
+}
+
+/**
+ * \brief Applies the latest stored percentage.
+ *
+ * The caller must hold the mutex. With a total set, this also feeds the
+ * throughput estimate, which is why the rate is only ever computed here.
+ *
+ * \return true if the number of filled units, the throughput stats or the
+ *         label changed since the last frame.
+ */
+bool SegmentBar::refresh() {
+    if (!finished) {
+        adoptSourceLabel(*source);
+        readSource();
+        int units = unitsFor(pendingPercentage());
+        if (units != current_units) {
+            current_units = units;
+            dirty = true;
+        }
+        if (sampleThroughput()) {
+            dirty = true;
+        }
+    }
+    return ProgressIndicator::refresh();
+}
+
+/**
+ * \brief Returns the filled part of the bar, in percent.
+ *
+ * \note The caller must hold the mutex.
+ */
+double SegmentBar::shownPercentage() const {
+    return 100.0 * current_units / total_units;
+}
+
+/**
+ * \brief Redraws the bar immediately from the calling thread.
+ *
+ * Managed bars are left for their MultiProgress to draw.
+ *
+ * \note The caller must hold the mutex.
+ */
+void SegmentBar::redraw() {
+    if (managed) {
+        return;
+    }
+    dirty = false;
+    drawFrame();
+}
@@ -0,0 +1,56 @@
+#include "progress_spinner/sharded_counter.hpp"
+
+/**
+ * \brief Constructor for ShardedCounter.
+ *
+ * \param shards Number of shards, rounded up to a power of two; 0 uses the
+ *               hardware concurrency.
+ */
+ShardedCounter::ShardedCounter(size_t shards) : total_units(0) {
+    if (shards == 0) {
+        shards = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    size_t size = 1;
+    while (size < shards) {
+        size *= 2;
+    }
+    this->shards = std::vector<Shard>(size);
+    mask = size - 1;
+}
+
+/**
+ * \brief Sets every shard back to 0.
+ *
+ * Must not race with updates; call it between parallel loops.
+ */
+void ShardedCounter::reset() {
+    for (Shard& shard : shards) {
+        shard.count.store(0, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief Sums the shards.
+ *
+ * Reads each shard once with relaxed loads, so the sum may lag the workers
+ * by a few units but never counts an update twice.
+ */
+uint64_t ShardedCounter::done() const {
+    uint64_t sum = 0;
+    for (const Shard& shard : shards) {
+        sum += shard.count.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+/**
+ * \brief Index of the calling thread's shard for advance().
+ *
+ * Threads get consecutive indices the first time they call advance(), so
+ * up to shardCount() threads each have a shard of their own.
+ */
+size_t ShardedCounter::threadSlot() {
+    static std::atomic<size_t> next_slot(0);
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
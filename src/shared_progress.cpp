@@ -0,0 +1,328 @@
+#include "progress_spinner/shared_progress.hpp"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "SharedProgress needs address-free atomics");
+
+constexpr size_t SharedProgress::label_capacity;
+
+/**
+ * \brief First cache line of the segment; tells an attaching process how
+ * many slots follow.
+ */
+struct alignas(cache_line_size) SharedProgress::Header {
+    static constexpr uint64_t expected_magic = 0x50524f4752455353; // "PROGRESS"
+    static constexpr uint32_t expected_version = 1;
+
+    std::atomic<uint64_t> magic;
+    uint32_t version;
+    uint32_t slot_count;
+};
+
+namespace {
+
+/**
+ * \brief One slot of a SharedProgress seen as a progress source of its own,
+ * e.g. for one row per worker.
+ */
+class SharedSlotSource : public ProgressSource {
+public:
+    explicit SharedSlotSource(const SharedProgress::Slot& slot) : slot(slot) {}
+
+    uint64_t done() const override {
+        return slot.done();
+    }
+
+    uint64_t total() const override {
+        return slot.total();
+    }
+
+    bool label(uint64_t& generation, std::string& text) const override {
+        return slot.label(generation, text);
+    }
+
+private:
+    const SharedProgress::Slot& slot;
+};
+
+[[noreturn]] void throwSystemError(const char* what) {
+    throw std::system_error(errno, std::generic_category(), std::string("SharedProgress: ") + what);
+}
+
+} // namespace
+
+/**
+ * \brief Publishes a new label for the slot.
+ *
+ * Labels longer than label_capacity bytes are cut at a character boundary.
+ * Not on the hot path: a label update takes a few more stores than a
+ * counter update, but still no system call.
+ *
+ * \param label The new label, UTF-8.
+ */
+void SharedProgress::Slot::setLabel(const std::string& label) {
+    size_t size = label.size();
+    if (size > label_capacity) {
+        size = label_capacity;
+        while (size > 0 && (static_cast<unsigned char>(label[size]) & 0xC0) == 0x80) {
+            --size;
+        }
+    }
+    uint64_t words[label_capacity / 8] = {};
+    std::memcpy(words, label.data(), size);
+
+    uint32_t sequence = label_sequence.load(std::memory_order_relaxed);
+    label_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < label_capacity / 8; ++i) {
+        label_words[i].store(words[i], std::memory_order_relaxed);
+    }
+    label_size.store(static_cast<uint32_t>(size), std::memory_order_relaxed);
+    label_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * \brief Reads the label if it changed since the caller last read it.
+ *
+ * \param generation The generation the caller has seen, 0 initially;
+ *                   updated when a newer label is returned.
+ * \param text Receives the label.
+ * \return true if text was set, false if the label is unchanged, was
+ *         never set or is being rewritten.
+ */
+bool SharedProgress::Slot::label(uint64_t& generation, std::string& text) const {
+    uint64_t words[label_capacity / 8];
+    // A worker that died while writing leaves the sequence odd for good
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        uint32_t before = label_sequence.load(std::memory_order_acquire);
+        if (before == generation) {
+            return false;
+        }
+        if (before % 2 != 0) {
+            continue;
+        }
+        for (size_t i = 0; i < label_capacity / 8; ++i) {
+            words[i] = label_words[i].load(std::memory_order_relaxed);
+        }
+        uint32_t size = label_size.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (label_sequence.load(std::memory_order_relaxed) == before && size <= label_capacity) {
+            text.assign(reinterpret_cast<const char*>(words), size);
+            generation = before;
+            return true;
+        }
+    }
+    return false;
+}
+
+SharedProgress::SharedProgress()
+    : header(nullptr), slots(nullptr), slot_count(0), mapped_size(0), owner_pid(0) {}
+
+/**
+ * \brief Constructor for SharedProgress; creates a new segment.
+ *
+ * \param count Number of slots, typically one per worker process; at least
+ *              1.
+ * \param name Name of the segment for shm_open(), e.g. "/my-job". Empty
+ *             creates an anonymous segment that only children created with
+ *             fork() afterwards can see. A named segment is removed again
+ *             when its creator is destroyed.
+ * \throws std::system_error if the segment cannot be created.
+ */
+SharedProgress::SharedProgress(size_t count, const std::string& name) : SharedProgress() {
+    if (count == 0 || count > UINT32_MAX) {
+        throw std::invalid_argument("SharedProgress: slots must be between 1 and 2^32 - 1, got " +
+                                    std::to_string(count));
+    }
+#ifdef _WIN32
+    (void)name;
+    throw std::runtime_error("SharedProgress: shared memory segments are not supported on Windows");
+#else
+    size_t size = sizeof(Header) + count * sizeof(Slot);
+    if (name.empty()) {
+        map(-1, size);
+    } else {
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            throwSystemError("shm_open");
+        }
+        // From here on the destructor removes the segment if anything fails
+        segment_name = name;
+        owner_pid = getpid();
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            int error = errno;
+            close(fd);
+            errno = error;
+            throwSystemError("ftruncate");
+        }
+        try {
+            map(fd, size);
+        } catch (...) {
+            close(fd);
+            throw;
+        }
+        close(fd);
+    }
+
+    // The mapping starts out zeroed; construct the objects in it
+    new (header) Header();
+    for (size_t i = 0; i < count; ++i) {
+        new (&slots[i]) Slot();
+    }
+    slot_count = count;
+    header->version = Header::expected_version;
+    header->slot_count = static_cast<uint32_t>(count);
+    header->magic.store(Header::expected_magic, std::memory_order_release);
+#endif
+}
+
+/**
+ * \brief Destructor for SharedProgress.
+ *
+ * Unmaps the segment. The process that created a named segment also
+ * removes its name, but forked children do not; processes still attached
+ * keep their mapping.
+ */
+SharedProgress::~SharedProgress() {
+#ifndef _WIN32
+    if (header != nullptr) {
+        munmap(header, mapped_size);
+    }
+    if (owner_pid != 0 && owner_pid == getpid()) {
+        shm_unlink(segment_name.c_str());
+    }
+#endif
+}
+
+/**
+ * \brief Attaches to a named segment created by another process.
+ *
+ * \param name The name the segment was created with.
+ * \throws std::system_error if the segment cannot be opened, and
+ *         std::runtime_error if it is not a SharedProgress segment.
+ */
+std::unique_ptr<SharedProgress> SharedProgress::attach(const std::string& name) {
+    std::unique_ptr<SharedProgress> progress(new SharedProgress());
+#ifdef _WIN32
+    (void)name;
+    throw std::runtime_error("SharedProgress: shared memory segments are not supported on Windows");
+#else
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        throwSystemError("shm_open");
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        throwSystemError("fstat");
+    }
+    size_t size = static_cast<size_t>(status.st_size);
+    if (size < sizeof(Header)) {
+        close(fd);
+        throw std::runtime_error("SharedProgress: " + name + " is not a progress segment");
+    }
+    try {
+        progress->map(fd, size);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
+    close(fd);
+
+    Header* header = progress->header;
+    if (header->magic.load(std::memory_order_acquire) != Header::expected_magic ||
+        header->version != Header::expected_version ||
+        sizeof(Header) + header->slot_count * sizeof(Slot) > size) {
+        throw std::runtime_error("SharedProgress: " + name + " is not a progress segment");
+    }
+    progress->slot_count = header->slot_count;
+#endif
+    return progress;
+}
+
+/**
+ * \brief Maps size bytes of fd, or anonymous memory if fd is -1, shared
+ * with other processes.
+ */
+void SharedProgress::map(int fd, size_t size) {
+#ifndef _WIN32
+    int flags = MAP_SHARED;
+    if (fd < 0) {
+        flags |= MAP_ANONYMOUS;
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (address == MAP_FAILED) {
+        throwSystemError("mmap");
+    }
+    header = static_cast<Header*>(address);
+    slots = reinterpret_cast<Slot*>(header + 1);
+    mapped_size = size;
+#else
+    (void)fd;
+    (void)size;
+#endif
+}
+
+/**
+ * \brief Returns the slot a worker reports to.
+ *
+ * Look the slot up once and keep the reference; updates through it are
+ * plain atomic stores.
+ *
+ * \param index Index of the slot, below slotCount().
+ * \throws std::out_of_range if there is no such slot.
+ */
+SharedProgress::Slot& SharedProgress::slot(size_t index) {
+    if (index >= slot_count) {
+        throw std::out_of_range("SharedProgress: slot " + std::to_string(index) + " out of " +
+                                std::to_string(slot_count));
+    }
+    return slots[index];
+}
+
+/**
+ * \brief Returns one slot as a source of its own, with its label.
+ *
+ * For a row per worker, e.g. in a MultiProgress. The SharedProgress must
+ * outlive every bar showing the source.
+ *
+ * \param index Index of the slot, below slotCount().
+ */
+std::shared_ptr<const ProgressSource> SharedProgress::source(size_t index) {
+    return std::make_shared<SharedSlotSource>(slot(index));
+}
+
+/**
+ * \brief Units done, summed over all slots.
+ */
+uint64_t SharedProgress::done() const {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < slot_count; ++i) {
+        sum += slots[i].done();
+    }
+    return sum;
+}
+
+/**
+ * \brief Units in total, summed over all slots.
+ */
+uint64_t SharedProgress::total() const {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < slot_count; ++i) {
+        sum += slots[i].total();
+    }
+    return sum;
+}
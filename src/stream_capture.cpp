@@ -0,0 +1,165 @@
+#include "progress_spinner/stream_capture.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * \brief Unfinished line of one thread for one capture.
+ */
+struct PendingLine {
+    uint64_t generation;
+    std::string text;
+};
+
+std::atomic<uint64_t> next_generation(1);
+
+// Generations of the captures that still exist
+std::mutex live_mutex;
+std::vector<uint64_t> live_generations;
+
+// Number of captures destroyed so far
+std::atomic<uint64_t> retired_captures(0);
+
+thread_local std::vector<PendingLine> pending_lines;
+
+// Value of retired_captures when this thread last pruned pending_lines
+thread_local uint64_t pruned_retired = 0;
+
+/**
+ * \brief Drops the calling thread's lines of captures that were destroyed
+ * since it last looked.
+ *
+ * Costs a single atomic load unless a capture went away.
+ */
+void pruneRetired() {
+    uint64_t retired = retired_captures.load(std::memory_order_acquire);
+    if (retired == pruned_retired) {
+        return;
+    }
+    pruned_retired = retired;
+    std::lock_guard<std::mutex> lock(live_mutex);
+    pending_lines.erase(std::remove_if(pending_lines.begin(), pending_lines.end(),
+                                       [](const PendingLine& entry) {
+                                           return std::find(live_generations.begin(), live_generations.end(),
+                                                            entry.generation) == live_generations.end();
+                                       }),
+                        pending_lines.end());
+}
+
+} // namespace
+
+/**
+ * \brief Constructor for StreamCapture; installs it as the buffer of stream.
+ *
+ * \param stream The stream to capture, e.g. std::cout.
+ * \param handler Called with every complete line, without its newline.
+ */
+StreamCapture::StreamCapture(std::ostream& stream, LineHandler handler)
+    : stream(stream),
+      original(nullptr),
+      handler(std::move(handler)),
+      generation(next_generation.fetch_add(1, std::memory_order_relaxed)) {
+    {
+        std::lock_guard<std::mutex> lock(live_mutex);
+        live_generations.push_back(generation);
+    }
+    // Text printed so far goes out as is, before anything captured
+    stream.flush();
+    original = stream.rdbuf(this);
+}
+
+/**
+ * \brief Destructor for StreamCapture; gives the stream its buffer back.
+ *
+ * An unfinished line of the calling thread is handed over first and its
+ * entry removed. Those of other threads are discarded the next time these
+ * threads write to a capture.
+ */
+StreamCapture::~StreamCapture() {
+    stream.rdbuf(original);
+    for (auto entry = pending_lines.begin(); entry != pending_lines.end(); ++entry) {
+        if (entry->generation != generation) {
+            continue;
+        }
+        std::string line = std::move(entry->text);
+        pending_lines.erase(entry);
+        if (!line.empty()) {
+            handler(line);
+        }
+        break;
+    }
+    {
+        std::lock_guard<std::mutex> lock(live_mutex);
+        live_generations.erase(std::find(live_generations.begin(), live_generations.end(), generation));
+    }
+    retired_captures.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * \brief Returns the calling thread's unfinished line for this capture.
+ *
+ * Entries left empty by other captures are reused and those of destroyed
+ * captures dropped, so a thread keeps at most one entry per live capture
+ * that has text pending.
+ */
+std::string& StreamCapture::pendingLine() {
+    pruneRetired();
+    PendingLine* free_entry = nullptr;
+    for (PendingLine& entry : pending_lines) {
+        if (entry.generation == generation) {
+            return entry.text;
+        }
+        if (free_entry == nullptr && entry.text.empty()) {
+            free_entry = &entry;
+        }
+    }
+    if (free_entry == nullptr) {
+        pending_lines.push_back(PendingLine{generation, std::string()});
+        free_entry = &pending_lines.back();
+    }
+    free_entry->generation = generation;
+    return free_entry->text;
+}
+
+/**
+ * \brief Adds one character; a newline hands the line over.
+ */
+StreamCapture::int_type StreamCapture::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+    }
+    char ch = traits_type::to_char_type(c);
+    xsputn(&ch, 1);
+    return c;
+}
+
+/**
+ * \brief Adds n characters, handing over every line they complete.
+ */
+std::streamsize StreamCapture::xsputn(const char* s, std::streamsize n) {
+    std::string& line = pendingLine();
+    const char* end = s + n;
+    const char* begin = s;
+    for (const char* p = begin; p != end; ++p) {
+        if (*p != '\n') {
+            continue;
+        }
+        line.append(begin, p);
+        handler(line);
+        line.clear();
+        begin = p + 1;
+    }
+    line.append(begin, end);
+    return n;
+}
+
+/**
+ * \brief Flushing does not hand over an unfinished line; lines are only
+ * printed whole.
+ */
+int StreamCapture::sync() {
+    return 0;
+}
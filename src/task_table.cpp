@@ -0,0 +1,510 @@
+#include "progress_spinner/task_table.hpp"
+#include "progress_spinner/text_width.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Tasks rated per frame besides those shown; bounds the cost of a frame
+const size_t scan_budget = 4096;
+
+// Tasks started last that are rated every frame; a power of two
+const size_t recent_capacity = 1024;
+
+// Time constant of the per-task activity average, in milliseconds
+const double activity_smoothing_ms = 2000.0;
+
+// Widest label column of the task rows
+const size_t max_label_width = 40;
+
+} // namespace
+
+/**
+ * \brief Constructor for TaskTable.
+ *
+ * All per-task arrays are allocated here, once; adding tasks allocates
+ * nothing but new labels.
+ *
+ * \param capacity Largest number of tasks the table can hold; between 1
+ *                 and 2^32 - 1.
+ * \param options TaskTableOptions with the number of rows, their order, the
+ *                refresh rate and the log interval.
+ * \throws std::invalid_argument if the capacity is out of range.
+ */
+TaskTable::TaskTable(size_t capacity, const TaskTableOptions& options)
+    : capacity(capacity),
+      top_tasks(static_cast<size_t>(options.top_tasks)),
+      task_order(options.task_order),
+      refresh_rate_hz(options.refresh_rate_hz),
+      log_interval_sec(options.log_interval_sec),
+      task_count(0),
+      recent_cursor(0),
+      total_sum(0),
+      state_counts{},
+      console(),
+      started_at(Clock::now()),
+      last_log(started_at),
+      scan_cursor(0),
+      drawn_rows(0),
+      previous_drawn_rows(0),
+      running(false) {
+    if (capacity == 0 || capacity > UINT32_MAX) {
+        throw std::invalid_argument("TaskTable: capacity must be between 1 and 2^32 - 1, got " +
+                                    std::to_string(capacity));
+    }
+    done_units.reset(new std::atomic<uint64_t>[capacity]());
+    total_units.reset(new std::atomic<uint64_t>[capacity]());
+    states.reset(new std::atomic<uint8_t>[capacity]());
+    label_ids.reset(new uint32_t[capacity]());
+    style_ids.reset(new StyleId[capacity]());
+    seen_done.reset(new uint64_t[capacity]());
+    seen_ms.reset(new uint32_t[capacity]());
+    activity.reset(new float[capacity]());
+    recent_starts.reset(new std::atomic<uint32_t>[recent_capacity]);
+    for (size_t i = 0; i < recent_capacity; ++i) {
+        recent_starts[i].store(UINT32_MAX, std::memory_order_relaxed);
+    }
+    styles.push_back(std::make_shared<const TaskStyle>());
+    candidates.reserve(scan_budget + recent_capacity + top_tasks);
+    shown.reserve(top_tasks);
+}
+
+/**
+ * \brief Destructor for TaskTable; stops it if it is still running.
+ */
+TaskTable::~TaskTable() {
+    stop();
+}
+
+/**
+ * \brief Adds a style that tasks can share.
+ *
+ * Style 0, the default, always exists.
+ *
+ * \param style The look of the task rows.
+ * \return Id of the style, for addTask().
+ * \throws std::invalid_argument if the style has no segments, and
+ *         std::length_error if there are too many styles.
+ */
+TaskTable::StyleId TaskTable::addStyle(const TaskStyle& style) {
+    if (style.segments <= 0) {
+        throw std::invalid_argument("TaskStyle: segments must be greater than 0, got " +
+                                    std::to_string(style.segments));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (styles.size() > UINT16_MAX) {
+        throw std::length_error("TaskTable: too many styles");
+    }
+    styles.push_back(std::make_shared<const TaskStyle>(style));
+    return static_cast<StyleId>(styles.size() - 1);
+}
+
+/**
+ * \brief Adds a queued task.
+ *
+ * Tasks with the same label share one copy of it. Tasks can be added from
+ * any thread while the table is drawn; they are never removed.
+ *
+ * \param label Label of the task's row, e.g. a file name.
+ * \param total Work units of the task, e.g. bytes; 0 if unknown.
+ * \param style Id of a style from addStyle(), 0 for the default.
+ * \return Id of the task, for the other calls.
+ * \throws std::length_error if the table is full, and std::out_of_range if
+ *         there is no such style.
+ */
+TaskTable::TaskId TaskTable::addTask(const std::string& label, uint64_t total, StyleId style) {
+    std::lock_guard<std::mutex> lock(mutex);
+    TaskId task = task_count.load(std::memory_order_relaxed);
+    if (task >= capacity) {
+        throw std::length_error("TaskTable: all " + std::to_string(capacity) + " tasks are in use");
+    }
+    if (style >= styles.size()) {
+        throw std::out_of_range("TaskTable: no style " + std::to_string(style));
+    }
+    auto found = label_index.find(label);
+    if (found == label_index.end()) {
+        found = label_index.emplace(label, static_cast<uint32_t>(labels.size())).first;
+        labels.push_back(label);
+        label_widths.push_back(displayWidth(label));
+    }
+    label_ids[task] = found->second;
+    style_ids[task] = style;
+    total_units[task].store(total, std::memory_order_relaxed);
+    total_sum.fetch_add(total, std::memory_order_relaxed);
+    state_counts[static_cast<size_t>(State::Queued)].fetch_add(1, std::memory_order_relaxed);
+    task_count.store(task + 1, std::memory_order_release);
+    return task;
+}
+
+/**
+ * \brief Sets the units done of a task.
+ *
+ * \param task Id of the task, from addTask() of this table.
+ * \param done Units done.
+ */
+void TaskTable::setDone(TaskId task, uint64_t done) {
+    assert(task < size());
+    uint64_t previous = done_units[task].exchange(done, std::memory_order_relaxed);
+    // Unsigned wraparound turns a decrease into the right sum
+    done_sum.advance(done - previous);
+}
+
+/**
+ * \brief Sets the work units of a task.
+ *
+ * \param task Id of the task, from addTask() of this table.
+ * \param total Work units; 0 if unknown.
+ */
+void TaskTable::setTotal(TaskId task, uint64_t total) {
+    assert(task < size());
+    uint64_t previous = total_units[task].exchange(total, std::memory_order_relaxed);
+    total_sum.fetch_add(total - previous, std::memory_order_relaxed);
+}
+
+/**
+ * \brief Marks a task as running, which makes it eligible for a row.
+ */
+void TaskTable::startTask(TaskId task) {
+    setState(task, State::Running);
+    uint32_t slot = recent_cursor.fetch_add(1, std::memory_order_relaxed);
+    recent_starts[slot % recent_capacity].store(task, std::memory_order_relaxed);
+}
+
+/**
+ * \brief Marks a task as done; all of its units count as done.
+ */
+void TaskTable::finishTask(TaskId task) {
+    uint64_t units = total(task);
+    if (units > 0) {
+        setDone(task, units);
+    }
+    setState(task, State::Done);
+}
+
+/**
+ * \brief Marks a task as failed.
+ */
+void TaskTable::failTask(TaskId task) {
+    setState(task, State::Failed);
+}
+
+/**
+ * \brief Changes the state of a task and the count of tasks per state.
+ */
+void TaskTable::setState(TaskId task, State state) {
+    assert(task < size());
+    uint8_t previous = states[task].exchange(static_cast<uint8_t>(state), std::memory_order_relaxed);
+    if (previous != static_cast<uint8_t>(state)) {
+        state_counts[previous].fetch_sub(1, std::memory_order_relaxed);
+        state_counts[static_cast<size_t>(state)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * \brief Hides the cursor and starts drawing the table.
+ */
+void TaskTable::start() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            return;
+        }
+        running = true;
+    }
+    console.flush();
+    console.showCursor(false);
+    RenderScheduler::instance().add(this, std::chrono::microseconds(1000000 / refresh_rate_hz));
+}
+
+/**
+ * \brief Draws the final state of the table and releases the terminal.
+ *
+ * Without a terminal, a last summary line is printed instead.
+ */
+void TaskTable::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    RenderScheduler::instance().remove(this);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    frame_buffer.clear();
+    if (!console.isTerminal()) {
+        composeSummary(frame_buffer);
+        frame_buffer += '\n';
+    } else {
+        pickShown(Clock::now());
+        composeBlock(frame_buffer);
+        // Rows left blank at the bottom are reused by the next output
+        if (drawn_rows > shown.size() + 1) {
+            ScreenLine::appendCursorMove(frame_buffer, drawn_rows - shown.size() - 1, 'A');
+        }
+        frame_buffer += '\n';
+    }
+    drawn_rows = 0;
+    for (ScreenLine& screen_line : screen_lines) {
+        screen_line.invalidate();
+    }
+    console.flush();
+    console.write(frame_buffer.data(), frame_buffer.size());
+    console.showCursor(true);
+}
+
+/**
+ * \brief Scheduler callback that redraws the table.
+ *
+ * Without a terminal, a summary line is printed every log interval instead.
+ *
+ * \param frame Batch buffer to append to.
+ */
+void TaskTable::renderFrame(std::string& frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    throughput.sample(done_sum.done(), now);
+    if (!console.isTerminal()) {
+        if (log_interval_sec > 0 && now - last_log >= std::chrono::seconds(log_interval_sec)) {
+            last_log = now;
+            composeSummary(frame);
+            frame += '\n';
+        }
+        return;
+    }
+    previous_drawn_rows = drawn_rows;
+    pickShown(now);
+    composeBlock(frame);
+}
+
+/**
+ * \brief Scheduler callback for a frame the sink dropped; the next frame
+ * redraws every row.
+ */
+void TaskTable::frameDropped() {
+    std::lock_guard<std::mutex> lock(mutex);
+    drawn_rows = previous_drawn_rows;
+    for (ScreenLine& screen_line : screen_lines) {
+        screen_line.invalidate();
+    }
+}
+
+/**
+ * \brief Picks the running tasks that get a row.
+ *
+ * Rates the next scan_budget tasks in turn, the tasks started last and the
+ * tasks already shown, and keeps the top ones among them. Tasks that stay in the top keep their
+ * row, so rows do not jump around between frames.
+ *
+ * \note The caller must hold the mutex.
+ */
+void TaskTable::pickShown(Clock::time_point now) {
+    uint32_t now_ms =
+        1 + static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - started_at).count());
+    size_t count = task_count.load(std::memory_order_acquire);
+    candidates.clear();
+    size_t budget = std::min(scan_budget, count);
+    for (size_t i = 0; i < budget; ++i) {
+        if (scan_cursor >= count) {
+            scan_cursor = 0;
+        }
+        addCandidate(static_cast<TaskId>(scan_cursor++), now_ms);
+    }
+    for (size_t i = 0; i < recent_capacity; ++i) {
+        uint32_t task = recent_starts[i].load(std::memory_order_relaxed);
+        if (task < count) {
+            addCandidate(task, now_ms);
+        }
+    }
+    for (TaskId task : shown) {
+        addCandidate(task, now_ms);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    size_t keep = std::min(top_tasks, candidates.size());
+    const float* rates = activity.get();
+    if (task_order == option::TaskOrder::Slowest) {
+        // Tasks not rated yet, with a negative activity, go last
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(), [rates](TaskId a, TaskId b) {
+            return rates[b] < 0.0f ? rates[a] >= 0.0f : rates[a] >= 0.0f && rates[a] < rates[b];
+        });
+    } else {
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [rates](TaskId a, TaskId b) { return rates[a] > rates[b]; });
+    }
+    candidates.resize(keep);
+
+    // Tasks still in the top keep their place; new ones fill the rows below
+    auto kept = std::remove_if(shown.begin(), shown.end(), [this](TaskId task) {
+        return std::find(candidates.begin(), candidates.end(), task) == candidates.end();
+    });
+    shown.erase(kept, shown.end());
+    for (TaskId task : candidates) {
+        if (std::find(shown.begin(), shown.end(), task) == shown.end()) {
+            shown.push_back(task);
+        }
+    }
+}
+
+/**
+ * \brief Rates a task and makes it a candidate for a row if it is running.
+ *
+ * \note The caller must hold the mutex.
+ */
+void TaskTable::addCandidate(TaskId task, uint32_t now_ms) {
+    observe(task, now_ms);
+    if (state(task) == State::Running) {
+        candidates.push_back(task);
+    }
+}
+
+/**
+ * \brief Updates the activity of a task, in units per second, from the
+ * units done since it was last rated.
+ *
+ * The average follows the measured rate the faster the longer the task was
+ * not rated, so a task rated once a minute gets the rate of that minute and
+ * one rated every frame is smoothed over a few seconds. Until a task was
+ * rated twice its activity is negative, meaning unknown.
+ *
+ * \note The caller must hold the mutex.
+ */
+void TaskTable::observe(TaskId task, uint32_t now_ms) {
+    uint64_t units = done(task);
+    uint32_t last_ms = seen_ms[task];
+    if (last_ms == now_ms) {
+        return;
+    }
+    if (last_ms == 0) {
+        activity[task] = -1.0f;
+    } else {
+        double elapsed_ms = static_cast<double>(now_ms - last_ms);
+        double rate = static_cast<double>(units - seen_done[task]) * 1000.0 / elapsed_ms;
+        double weight = activity[task] < 0.0f ? 1.0 : std::min(1.0, elapsed_ms / activity_smoothing_ms);
+        activity[task] = static_cast<float>(activity[task] + weight * (rate - activity[task]));
+    }
+    seen_done[task] = units;
+    seen_ms[task] = now_ms;
+}
+
+/**
+ * \brief Appends the summary line over all tasks.
+ *
+ * \note The caller must hold the mutex.
+ */
+void TaskTable::composeSummary(std::string& line) {
+    appendUnsigned(line, count(State::Done));
+    line += '/';
+    appendUnsigned(line, size());
+    line += " tasks done, ";
+    appendUnsigned(line, count(State::Running));
+    line += " running, ";
+    appendUnsigned(line, count(State::Queued));
+    line += " queued";
+    size_t failed = count(State::Failed);
+    if (failed > 0) {
+        line += ", ";
+        appendUnsigned(line, failed);
+        line += " failed";
+    }
+    uint64_t units = total_sum.load(std::memory_order_relaxed);
+    if (units > 0) {
+        uint64_t done_units_sum = done_sum.done();
+        uint64_t percent = std::min<uint64_t>(100, static_cast<uint64_t>(
+            100.0 * static_cast<double>(done_units_sum) / static_cast<double>(units)));
+        line += "  ";
+        appendUnsigned(line, percent);
+        line += '%';
+        throughput.appendStats(line, done_units_sum, units);
+    }
+}
+
+/**
+ * \brief Appends the row of one task.
+ *
+ * \param task Id of the task, from addTask() of this table.
+ * \param label_width Display width the label is padded or shortened to.
+ * \param line The line to append to.
+ * \note The caller must hold the mutex.
+ */
+void TaskTable::composeTask(TaskId task, size_t label_width, std::string& line) {
+    uint32_t label_id = label_ids[task];
+    size_t width = appendEllipsized(line, labels[label_id], label_widths[label_id], label_width);
+    line.append(label_width - width + 1, ' ');
+
+    const TaskStyle& style = *styles[style_ids[task]];
+    uint64_t units = total(task);
+    uint64_t done_units_task = done(task);
+    double share = units > 0 ? std::min(1.0, static_cast<double>(done_units_task) / static_cast<double>(units)) : 0.0;
+    int filled = static_cast<int>(share * style.segments);
+    for (int i = 0; i < style.segments; ++i) {
+        line += i < filled ? style.filled : style.empty;
+    }
+
+    line += ' ';
+    if (units > 0) {
+        int percent = static_cast<int>(share * 100.0);
+        line.append(percent < 10 ? 2 : percent < 100 ? 1 : 0, ' ');
+        appendUnsigned(line, static_cast<uint64_t>(percent));
+        line += "% ";
+    }
+    appendQuantity(line, static_cast<double>(done_units_task));
+    if (units > 0) {
+        line += '/';
+        appendQuantity(line, static_cast<double>(units));
+    }
+    line += ' ';
+    appendQuantity(line, std::max(0.0f, activity[task]));
+    line += "/s";
+}
+
+/**
+ * \brief Composes the summary line and the task rows and appends what
+ * changed on screen to frame.
+ *
+ * The block grows to fit the rows but never shrinks; rows without a task
+ * are left blank. Between frames the cursor rests on the last row.
+ *
+ * \note The caller must hold the mutex.
+ */
+void TaskTable::composeBlock(std::string& frame) {
+    size_t rows = std::max(lines.size(), shown.size() + 1);
+    lines.resize(rows);
+    screen_lines.resize(rows);
+    size_t columns = console.columns();
+
+    size_t label_width = 0;
+    for (TaskId task : shown) {
+        label_width = std::max(label_width, label_widths[label_ids[task]]);
+    }
+    label_width = std::min(label_width, columns > 0 ? std::min(max_label_width, columns / 3) : max_label_width);
+
+    for (size_t i = 0; i < rows; ++i) {
+        lines[i].clear();
+        if (i == 0) {
+            composeSummary(lines[i]);
+        } else if (i - 1 < shown.size()) {
+            composeTask(shown[i - 1], label_width, lines[i]);
+        }
+        // The last column is left free, like every indicator line
+        if (columns > 0) {
+            ellipsizeInPlace(lines[i], columns - 1);
+        }
+    }
+
+    size_t cursor_row = drawn_rows > 0 ? drawn_rows - 1 : 0;
+    for (size_t i = 0; i < rows; ++i) {
+        if (i < drawn_rows && screen_lines[i].shows(lines[i])) {
+            continue;
+        }
+        ScreenLine::moveToRow(frame, drawn_rows, cursor_row, i);
+        screen_lines[i].update(lines[i], frame);
+        drawn_rows = std::max(drawn_rows, i + 1);
+    }
+    if (drawn_rows > 0) {
+        ScreenLine::moveToRow(frame, drawn_rows, cursor_row, drawn_rows - 1);
+    }
+}
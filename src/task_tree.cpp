@@ -0,0 +1,135 @@
+#include "progress_spinner/task_tree.hpp"
+#include <stdexcept>
+#include <string>
+
+/**
+ * \brief Constructor for TaskNode.
+ *
+ * \param weight Share of the parent's progress this task stands for,
+ *               relative to its siblings; must not be negative.
+ * \param total Work units of the task while it is a leaf. A leaf without a
+ *              total counts as a single unit that is done once complete()
+ *              is called.
+ */
+TaskNode::TaskNode(double weight, uint64_t total)
+    : node_weight(weight),
+      done_units(0),
+      total_units(total),
+      completed(false),
+      first_child(nullptr),
+      next_sibling(nullptr) {
+    if (!(weight >= 0.0)) {
+        throw std::invalid_argument("TaskNode: weight cannot be negative, got " + std::to_string(weight));
+    }
+}
+
+/**
+ * \brief Destructor for TaskNode; deletes the whole subtree.
+ */
+TaskNode::~TaskNode() {
+    TaskNode* child = first_child.load(std::memory_order_acquire);
+    while (child != nullptr) {
+        TaskNode* next = child->next_sibling;
+        delete child;
+        child = next;
+    }
+}
+
+/**
+ * \brief Adds a subtask.
+ *
+ * The child is linked in with a single compare-and-swap, so readers walking
+ * the tree at the same time see it either completely or not at all. From
+ * then on this node's own counter is ignored.
+ *
+ * \param weight Share of this node's progress the child stands for,
+ *               relative to its siblings.
+ * \param total Work units of the child.
+ * \return The new child, owned by this node.
+ */
+TaskNode& TaskNode::addChild(double weight, uint64_t total) {
+    TaskNode* child = new TaskNode(weight, total);
+    TaskNode* head = first_child.load(std::memory_order_relaxed);
+    do {
+        child->next_sibling = head;
+    } while (!first_child.compare_exchange_weak(head, child, std::memory_order_release,
+                                                std::memory_order_relaxed));
+    return *child;
+}
+
+/**
+ * \brief Units done, summed over the leaves of the subtree.
+ *
+ * A completed node counts all of its units as done.
+ */
+uint64_t TaskNode::done() const {
+    return aggregate().done;
+}
+
+/**
+ * \brief Units in total, summed over the leaves of the subtree.
+ */
+uint64_t TaskNode::total() const {
+    return aggregate().total;
+}
+
+/**
+ * \brief Completed share of the task, between 0 and 1.
+ *
+ * A leaf reports done / total. An inner node reports the weighted mean of
+ * its children, so a phase of weight 3 moves the job three times as much as
+ * one of weight 1 regardless of how many units either counts. complete()
+ * marks any node as finished.
+ */
+double TaskNode::fraction() const {
+    return aggregate().fraction;
+}
+
+/**
+ * \brief Computes done(), total() and fraction() in a single walk of the
+ * subtree.
+ *
+ * A leaf without a total counts as one unit. The children are read once
+ * each, so the three values always agree with each other even while
+ * producers keep counting.
+ */
+ProgressAggregate TaskNode::aggregate() const {
+    ProgressAggregate progress;
+    bool finished = completed.load(std::memory_order_relaxed);
+    TaskNode* child = first_child.load(std::memory_order_acquire);
+    if (child == nullptr) {
+        uint64_t units = total_units.load(std::memory_order_relaxed);
+        progress.total = units == 0 ? 1 : units;
+        if (finished) {
+            progress.done = progress.total;
+            progress.fraction = 1.0;
+        } else if (units == 0) {
+            progress.done = 0;
+            progress.fraction = 0.0;
+        } else {
+            progress.done = done_units.load(std::memory_order_relaxed);
+            double share = static_cast<double>(progress.done) / static_cast<double>(units);
+            progress.fraction = share < 1.0 ? share : 1.0;
+        }
+        return progress;
+    }
+
+    progress.done = 0;
+    progress.total = 0;
+    double weighted = 0.0;
+    double weights = 0.0;
+    for (; child != nullptr; child = child->next_sibling) {
+        ProgressAggregate part = child->aggregate();
+        progress.done += part.done;
+        progress.total += part.total;
+        weighted += child->node_weight * part.fraction;
+        weights += child->node_weight;
+    }
+    if (finished) {
+        progress.done = progress.total;
+        progress.fraction = 1.0;
+    } else {
+        progress.fraction = weights > 0.0 ? weighted / weights : 0.0;
+    }
+    return progress;
+}
@@ -0,0 +1,212 @@
+#include "progress_spinner/text_width.hpp"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PROGRESS_INDICATOR_HAVE_SSE2 1
+#endif
+
+namespace {
+
+using text_width_detail::codePointWidth;
+using text_width_detail::decodeUtf8;
+
+/**
+ * \brief Length of the leading run of ASCII bytes.
+ *
+ * Checks 16 bytes per step with SSE2 where available and 8 bytes per step
+ * otherwise, so plain ASCII labels are measured without decoding.
+ */
+size_t asciiPrefix(const char* text, size_t size) {
+    size_t i = 0;
+#ifdef PROGRESS_INDICATOR_HAVE_SSE2
+    while (i + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        if (_mm_movemask_epi8(chunk) != 0) {
+            break;
+        }
+        i += 16;
+    }
+#endif
+    while (i + 8 <= size) {
+        uint64_t word;
+        std::memcpy(&word, text + i, sizeof(word));
+        if ((word & 0x8080808080808080ULL) != 0) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < size && static_cast<unsigned char>(text[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * \brief Byte length of the longest prefix of text that fits in width
+ * cells.
+ *
+ * Whole code points are kept or dropped; malformed bytes count as one cell.
+ *
+ * \param cells Receives the display width of the prefix.
+ */
+size_t fittingPrefix(const char* text, size_t size, size_t width, size_t& cells) {
+    size_t used = 0;
+    size_t i = 0;
+    while (i < size) {
+        size_t length = 1;
+        size_t code_cells = 1;
+        if (static_cast<unsigned char>(text[i]) >= 0x80) {
+            uint32_t code_point;
+            length = decodeUtf8(text + i, size - i, code_point);
+            if (length == 0) {
+                length = 1;
+            } else {
+                code_cells = codePointWidth(code_point);
+            }
+        }
+        if (used + code_cells > width) {
+            break;
+        }
+        used += code_cells;
+        i += length;
+    }
+    cells = used;
+    return i;
+}
+
+} // namespace
+
+/**
+ * \brief Number of console cells taken by a run of UTF-8 text.
+ *
+ * ASCII bytes take one cell each and are counted in bulk. Other code points
+ * take zero cells (combining marks, zero-width characters), two cells (wide
+ * East Asian characters and emoji) or one cell. Malformed bytes count as one
+ * cell each.
+ *
+ * \param text The text to measure.
+ * \param size Number of bytes in text.
+ */
+size_t displayWidth(const char* text, size_t size) {
+    size_t width = 0;
+    size_t i = 0;
+    while (i < size) {
+        size_t ascii = asciiPrefix(text + i, size - i);
+        width += ascii;
+        i += ascii;
+        if (i == size) {
+            break;
+        }
+
+        uint32_t code_point;
+        size_t length = decodeUtf8(text + i, size - i, code_point);
+        if (length == 0) {
+            width += 1;
+            i += 1;
+        } else {
+            width += codePointWidth(code_point);
+            i += length;
+        }
+    }
+    return width;
+}
+
+/**
+ * \brief Checks that text is well-formed UTF-8.
+ *
+ * \param text The text to check.
+ * \param size Number of bytes in text.
+ */
+bool isValidUtf8(const char* text, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        i += asciiPrefix(text + i, size - i);
+        if (i == size) {
+            break;
+        }
+        uint32_t code_point;
+        size_t length = decodeUtf8(text + i, size - i, code_point);
+        if (length == 0) {
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
+
+/**
+ * \brief Cuts text to at most width console cells, ending in an ellipsis if
+ * anything was cut.
+ *
+ * Whole code points are kept or dropped, so the result is still valid UTF-8
+ * when text is. Combining marks stay with the character before them.
+ *
+ * \param text The text to shorten.
+ * \param width Maximum display width of the result.
+ * \return text itself if it fits, otherwise its longest prefix that fits in
+ *         width - 1 cells followed by "…".
+ */
+std::string ellipsize(const std::string& text, size_t width) {
+    std::string fitted;
+    appendEllipsized(fitted, text, displayWidth(text), width);
+    return fitted;
+}
+
+/**
+ * \brief Appends text to line, cut like ellipsize() to at most width cells.
+ *
+ * For callers that know the width of text already, e.g. from when it was
+ * set, and append into a reused buffer: nothing is measured or allocated
+ * unless text has to be cut.
+ *
+ * \param line The line to append to.
+ * \param text The text to append.
+ * \param text_width Display width of text.
+ * \param width Maximum display width of what is appended.
+ * \return The display width appended.
+ */
+size_t appendEllipsized(std::string& line, const std::string& text, size_t text_width, size_t width) {
+    if (text_width <= width) {
+        line += text;
+        return text_width;
+    }
+    if (width == 0) {
+        return 0;
+    }
+    size_t cells = 0;
+    line.append(text, 0, fittingPrefix(text.data(), text.size(), width - 1, cells));
+    line += "…";
+    return cells + 1;
+}
+
+/**
+ * \brief Cuts text like ellipsize(), keeping its buffer.
+ *
+ * \param text The text to shorten.
+ * \param width Maximum display width of the result.
+ */
+void ellipsizeInPlace(std::string& text, size_t width) {
+    if (displayWidth(text) <= width) {
+        return;
+    }
+    size_t cells = 0;
+    text.resize(width == 0 ? 0 : fittingPrefix(text.data(), text.size(), width - 1, cells));
+    if (width > 0) {
+        text += "…";
+    }
+}
+
+/**
+ * \brief Constructor for Glyph.
+ *
+ * \param text The UTF-8 text of the glyph.
+ * \throws std::invalid_argument if text is not valid UTF-8.
+ */
+Glyph::Glyph(const std::string& text) : bytes(text), width(displayWidth(text)) {
+    if (!isValidUtf8(text)) {
+        throw std::invalid_argument("Glyph is not valid UTF-8: \"" + text + "\"");
+    }
+}
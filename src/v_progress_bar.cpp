@@ -1,6 +1,7 @@
 #include "progress_spinner/v_progress_bar.hpp"
+#include "progress_spinner/text_width.hpp"
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 #include <mutex>
 
 /**
@@ -10,20 +11,41 @@
  *
  * VProgressBar constructor validates the options and throws std::invalid_argument if
  * char_frames is empty. It also sets the cursor to false and calls `redraw()` to
- * display the initial bar.
+ * display the initial bar. If a refresh rate is set, the renderer is started
+ * here, since VProgressBar has no separate start step; for the same reason
+ * the bar registers for export here, once it is fully built.
  */
 VProgressBar::VProgressBar(const VProgressBarOptions& options)
-    : ProgressIndicator(options.progress_label, options.completed_label),
+    : WorkProgressIndicator(options.progress_label, options.completed_label, options.refresh_rate_hz),
         chars(options.chars),
         completed(false),
         current_percentage(0.0),
-        displayed_completed_label(false) {
+        displayed_completed_label(false),
+        drawn_frame(0),
+        glyph_width(0) {
     if (chars.size() < 2) {
         throw std::invalid_argument("char_frames must have exactly 2 elements (for empty and filled states), got " + std::to_string(chars.size()));
     }
     tick = 100.0 / (static_cast<double>(chars.size()) - 1);
+    for (const std::string& glyph : chars) {
+        glyph_width = std::max(glyph_width, displayWidth(glyph));
+    }
+    log_line = LogLine(options.log_interval_sec, options.log_percent_step);
     showCursor(false);
     redraw();
+    startRendering();
+    registerIndicator();
+}
+
+/**
+ * \brief Destructor for VProgressBar.
+ *
+ * Leaves the list of live indicators and stops the renderer, if one is
+ * running, before the bar state goes away.
+ */
+VProgressBar::~VProgressBar() {
+    unregisterIndicator();
+    stopRenderer();
 }
 
 /**
@@ -39,34 +61,44 @@ void VProgressBar::start() {}
  * \brief Stop the progress bar.
  *
  * Stop the progress bar, redraw the bar with the completed label, and show the
- * cursor. This is usually called when the task is complete.
+ * cursor. This is usually called when the task is complete. The completed
+ * label is only printed once, even if the bar already finished by reaching
+ * 100%.
  */
 void VProgressBar::stop() {
-    clearLine();
-    std::cout << progress_label << completed_label << std::endl;
-    std::cout << std::flush;
-    showCursor(true);
+    stopRenderer();
+    {
+        TimedLock lock(mutex, counters);
+        completed = true;
+        dirty = true;
+        frame_buffer.clear();
+        finish(frame_buffer);
+        writeFinalFrame(frame_buffer);
+    }
+    retireIndicator();
+    dumpStats();
 }
 
 /**
- * \brief Update the progress bar by updating the progress to new_percentage.
- *
- * This method does not need to be thread-safe as it is already protected by a mutex.
- * If new_percentage is 100 or greater, the progress bar will be stopped and the
- * completed label will be displayed. Otherwise, the progress bar will be redrawn
- * with the updated progress.
- * \param new_percentage New percentage value between 0 and 100.
- * \note If new_percentage is less than 0, the progress bar remains at 0.
- *       If new_percentage is greater than 100, the progress bar remains at 100.
+ * \brief Show the latest percentage passed to updateProgress().
+ *
+ * If it is 100 or greater, the completed label is displayed. Otherwise, the
+ * bar is redrawn with the updated progress; percentages below 0 show an
+ * empty bar.
+ *
+ * \note The caller must hold the mutex.
  */
-void VProgressBar::updateProgress(double new_percentage) {
-    std::lock_guard<std::mutex> lock(mutex);
+void VProgressBar::applyProgress() {
+    readSource();
+    double new_percentage = pendingPercentage();
 
     if (new_percentage >= 100.0) {
         new_percentage = 100.0;
         if (!completed) {
             completed = true;
-            stop();
+            frame_buffer.clear();
+            finish(frame_buffer);
+            writeFinalFrame(frame_buffer);
             return;
         }
     } else {
@@ -82,45 +114,201 @@ void VProgressBar::updateProgress(double new_percentage) {
  *
  * \param new_text The new label string.
  *
- * This method does not need to be thread-safe as it is already protected by a mutex.
- * The label is updated and the bar is redrawn with the new label.
+ * The label is updated and the bar is redrawn with the new label, either
+ * immediately or on the next renderer tick.
  */
 void VProgressBar::updateText(const std::string& new_text) {
-    std::lock_guard<std::mutex> lock(mutex);
-    progress_label = new_text;
+    counters.countUpdate();
+    TimedLock lock(mutex, counters);
+    setLabel(new_text);
     completed = false;
     displayed_completed_label = false;
+    dirty = true;
+    if (deferred()) {
+        return;
+    }
     redraw();
 }
 
+/**
+ * \brief Add completion to the snapshot once the bar is complete.
+ *
+ * The caller must hold the mutex.
+ */
+void VProgressBar::fillSnapshot(ProgressSnapshot& snapshot) {
+    WorkProgressIndicator::fillSnapshot(snapshot);
+    if (completed) {
+        snapshot.percentage = 100.0;
+        snapshot.state = ProgressSnapshot::State::Done;
+    }
+}
 
 /**
- * \brief Redraw the vertical progress bar with the updated progress.
+ * \brief Append the frame for freshly refreshed state to frame.
  *
- * This method redoes the vertical progress bar, using the current percentage
- * value to determine which frame to display. The frame index is calculated as
+ * The caller must hold the mutex.
+ *
+ * \param frame The frame buffer to append to.
+ */
+void VProgressBar::composeRefreshed(std::string& frame) {
+    if (completed) {
+        finish(frame);
+        return;
+    }
+    composeFrame(frame);
+}
+
+/**
+ * \brief Applies the latest stored percentage.
+ *
+ * The caller must hold the mutex. Once the completed label is on screen the
+ * bar keeps it until the label is changed again.
+ *
+ * \return true if the displayed frame, the completion state, the throughput
+ *         stats or the label changed since the last frame.
+ */
+bool VProgressBar::refresh() {
+    if (!displayed_completed_label) {
+        adoptSourceLabel(*source);
+        readSource();
+        double percentage = pendingPercentage();
+        if (percentage >= 100.0) {
+            if (!completed) {
+                completed = true;
+                dirty = true;
+            }
+        } else {
+            if (completed) {
+                completed = false;
+                dirty = true;
+            }
+            current_percentage = percentage;
+            size_t frame_index = frameIndex(current_percentage);
+            if (frame_index != drawn_frame) {
+                drawn_frame = frame_index;
+                dirty = true;
+            }
+            if (sampleThroughput()) {
+                dirty = true;
+            }
+        }
+    }
+    return ProgressIndicator::refresh();
+}
+
+/**
+ * \brief Return the progress shown by the bar, in percent.
+ *
+ * \note The caller must hold the mutex.
+ */
+double VProgressBar::shownPercentage() const {
+    if (completed) {
+        return 100.0;
+    }
+    return current_percentage < 0.0 ? 0.0 : current_percentage;
+}
+
+/**
+ * \brief Append the visible content of the bar to line.
+ *
+ * Shows the completed label once the bar is complete, and the throughput
+ * and ETA while counting work units. On a terminal, the label is shortened
+ * with an ellipsis if the line would not fit otherwise.
+ *
+ * \note The caller must hold the mutex.
+ */
+void VProgressBar::composeLine(std::string& line) {
+    size_t columns = console.columns();
+    if (completed) {
+        line += fittedLabel(columns, completedWidth());
+        line += completed_label;
+        return;
+    }
+
+    composeStats();
+    bool show_stats = fitsLine(columns, glyph_width + stats_reserve);
+    line += fittedLabel(columns, glyph_width + (show_stats ? stats_reserve : 0));
+    line += chars[drawn_frame];
+    if (show_stats) {
+        line += stats_text;
+    }
+}
+
+/**
+ * \brief Forget the last frame, which never reached the screen.
+ *
+ * The caller must hold the mutex. If that frame was the completed label,
+ * it is printed again with the next frame.
+ */
+void VProgressBar::discardFrame() {
+    ProgressIndicator::discardFrame();
+    if (completed) {
+        displayed_completed_label = false;
+    }
+}
+
+/**
+ * \brief Append the completed label to frame and restore the cursor.
+ *
+ * The caller must hold the mutex. Does nothing if the completed label is
+ * already on screen. The cursor is shown by the frame itself, since it may
+ * be written later by the renderer; showing it right away would put the
+ * cursor back before the completed label.
+ *
+ * \param frame The frame buffer to append to.
+ */
+void VProgressBar::finish(std::string& frame) {
+    if (displayed_completed_label) {
+        return;
+    }
+    displayed_completed_label = true;
+    composeFinalFrame(frame);
+    if (!managed && console.isTerminal()) {
+        frame += "\033[?25h";
+    }
+}
+
+/**
+ * \brief Map a percentage to the index of the frame to display.
+ *
+ * The frame index is calculated as
  * `(percentage / final_frame_threshold) * (num_frames - frame_offset)`.
  * The final frame is shown if the percentage is greater than or equal to
  * `final_frame_threshold`. The frame index is clamped to the valid range
  * `[frame_offset, num_frames - frame_offset)`.
  *
- * \note This method is thread-safe as it is protected by a mutex.
+ * \param percentage Percentage value between 0 and 100.
  */
-void VProgressBar::redraw() {
+size_t VProgressBar::frameIndex(double percentage) const {
     using std::min;  // Ensure std::min is used to avoid macro conflicts
 
     const double final_frame_threshold = 75.0;  // Threshold to start showing the final frame
     const size_t frame_offset = 1;              // Offset to map percentage to frame index
 
-    double percentage = min(current_percentage, 100.0);
+    if (percentage < 0.0) percentage = 0.0;
+    percentage = min(percentage, 100.0);
     double scaled_percentage = (percentage / final_frame_threshold);
     size_t num_frames = chars.size();
     size_t frame_index = static_cast<size_t>(
         std::floor(scaled_percentage * (num_frames - frame_offset))
     );
 
-    frame_index = min(frame_index, num_frames - frame_offset);
+    return min(frame_index, num_frames - frame_offset);
+}
 
-    clearLine();
-    std::cout << progress_label << chars[frame_index] << std::flush;
+/**
+ * \brief Redraw the vertical progress bar with the updated progress.
+ *
+ * Uses the current percentage value to determine which frame to display.
+ * Managed bars are left for their MultiProgress to draw.
+ *
+ * \note The caller must hold the mutex.
+ */
+void VProgressBar::redraw() {
+    if (managed) {
+        return;
+    }
+    drawn_frame = frameIndex(current_percentage);
+    dirty = false;
+    drawFrame();
 }
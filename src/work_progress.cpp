@@ -0,0 +1,195 @@
+#include "progress_spinner/work_progress.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Minimum time between two rate samples
+const std::chrono::milliseconds sample_interval(200);
+
+// Time constant of the moving average, in seconds
+const double smoothing_seconds = 3.0;
+
+} // namespace
+
+/**
+ * \brief Appends the decimal digits of value, without a temporary string.
+ */
+void appendUnsigned(std::string& line, uint64_t value) {
+    char digits[20];
+    size_t length = 0;
+    do {
+        digits[length++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (length > 0) {
+        line += digits[--length];
+    }
+}
+
+/**
+ * \brief Appends a quantity with at most three significant digits.
+ *
+ * Values of 1000 and more get a k, M, G or T suffix, e.g. "950", "1.2k",
+ * "34.5M".
+ */
+void appendQuantity(std::string& line, double value) {
+    static const char suffixes[] = {'\0', 'k', 'M', 'G', 'T'};
+    size_t suffix = 0;
+    while (value >= 999.5 && suffix + 1 < sizeof(suffixes)) {
+        value /= 1000.0;
+        ++suffix;
+    }
+    if (suffix == 0 || value >= 99.95) {
+        appendUnsigned(line, static_cast<uint64_t>(std::round(value)));
+    } else {
+        uint64_t tenths = static_cast<uint64_t>(std::round(value * 10.0));
+        appendUnsigned(line, tenths / 10);
+        line += '.';
+        line += static_cast<char>('0' + tenths % 10);
+    }
+    if (suffixes[suffix] != '\0') {
+        line += suffixes[suffix];
+    }
+}
+
+namespace {
+
+void appendTwoDigits(std::string& line, uint64_t value) {
+    line += static_cast<char>('0' + value / 10);
+    line += static_cast<char>('0' + value % 10);
+}
+
+/**
+ * \brief Appends a duration as m:ss, or h:mm:ss from one hour on.
+ */
+void appendDuration(std::string& line, uint64_t seconds) {
+    uint64_t hours = seconds / 3600;
+    uint64_t minutes = seconds / 60 % 60;
+    if (hours > 0) {
+        appendUnsigned(line, hours);
+        line += ':';
+        appendTwoDigits(line, minutes);
+    } else {
+        appendUnsigned(line, minutes);
+    }
+    line += ':';
+    appendTwoDigits(line, seconds % 60);
+}
+
+} // namespace
+
+/**
+ * \brief Constructor for WorkCounter.
+ *
+ * Starts with nothing done and no total.
+ */
+WorkCounter::WorkCounter() : done_units(0), total_units(0) {}
+
+/**
+ * \brief Constructor for ThroughputEstimator.
+ */
+ThroughputEstimator::ThroughputEstimator()
+    : last_done(0),
+      items_per_second(0.0),
+      has_sample(false),
+      has_rate(false) {}
+
+/**
+ * \brief Feeds the current done count into the estimate.
+ *
+ * Calls closer together than the sample interval are ignored, so this can
+ * be called on every frame. A done count that went backwards restarts the
+ * estimate.
+ *
+ * \param done Number of units done so far.
+ * \param now Current time.
+ * \return true if a new sample was taken, i.e. the rate or ETA may have
+ *         changed.
+ */
+bool ThroughputEstimator::sample(uint64_t done, Clock::time_point now) {
+    if (!has_sample || done < last_done) {
+        last_time = now;
+        last_done = done;
+        has_sample = true;
+        return false;
+    }
+
+    std::chrono::duration<double> elapsed = now - last_time;
+    if (elapsed < sample_interval) {
+        return false;
+    }
+
+    double instant_rate = static_cast<double>(done - last_done) / elapsed.count();
+    if (has_rate) {
+        double alpha = 1.0 - std::exp(-elapsed.count() / smoothing_seconds);
+        items_per_second += alpha * (instant_rate - items_per_second);
+    } else {
+        items_per_second = instant_rate;
+        has_rate = true;
+    }
+    last_time = now;
+    last_done = done;
+    return true;
+}
+
+/**
+ * \brief Forgets all samples, e.g. when a bar is restarted.
+ */
+void ThroughputEstimator::reset() {
+    last_done = 0;
+    items_per_second = 0.0;
+    has_sample = false;
+    has_rate = false;
+}
+
+/**
+ * \brief Estimates the seconds until done reaches total at the current rate.
+ *
+ * \return The estimate, 0 once all work is done, or -1 if there is no total
+ *         or no rate yet.
+ */
+double ThroughputEstimator::etaSeconds(uint64_t done, uint64_t total) const {
+    if (total == 0) {
+        return -1.0;
+    }
+    if (done >= total) {
+        return 0.0;
+    }
+    if (!has_rate || items_per_second <= 0.0) {
+        return -1.0;
+    }
+    return static_cast<double>(total - done) / items_per_second;
+}
+
+/**
+ * \brief Appends " done/total rate/s ETA m:ss" to line.
+ *
+ * The rate is shown as "--" and the ETA as "--:--" until they are known.
+ * The ETA is rounded up, so it only reads 0:00 once all work is done.
+ *
+ * \param line The line to append to.
+ * \param done Number of units done.
+ * \param total Total number of units.
+ */
+void ThroughputEstimator::appendStats(std::string& line, uint64_t done, uint64_t total) const {
+    line += ' ';
+    appendQuantity(line, static_cast<double>(done));
+    line += '/';
+    appendQuantity(line, static_cast<double>(total));
+    line += ' ';
+    if (has_rate) {
+        appendQuantity(line, items_per_second);
+    } else {
+        line += "--";
+    }
+    line += "/s ETA ";
+    if (done >= total) {
+        appendDuration(line, 0);
+    } else if (items_per_second > 0.0) {
+        double remaining = static_cast<double>(total - done) / items_per_second;
+        appendDuration(line, static_cast<uint64_t>(std::ceil(std::min(remaining, 359999.0))));
+    } else {
+        line += "--:--";
+    }
+}
@@ -0,0 +1,289 @@
+#include "progress_spinner/work_progress_indicator.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+// Redraw rate of immediate-mode bars while they count work units
+constexpr std::chrono::microseconds work_interval(1000000 / 30);
+
+} // namespace
+
+/**
+ * \brief Constructor for WorkProgressIndicator.
+ *
+ * \param progress_label The initial label string.
+ * \param completed_label The string to display when the task is complete.
+ * \param refresh_rate_hz Maximum redraws per second, or 0 to redraw on every
+ *                        update.
+ */
+WorkProgressIndicator::WorkProgressIndicator(const std::string& progress_label,
+                                             const std::string& completed_label, int refresh_rate_hz)
+    : ProgressIndicator(progress_label, completed_label),
+      source(&work),
+      source_progress(),
+      stats_reserve(0),
+      refresh_rate_hz(refresh_rate_hz),
+      pending_percentage(0.0),
+      following_work(false) {}
+
+/**
+ * \brief Sets the progress of the bar.
+ *
+ * In immediate mode the bar is redrawn right away. Otherwise this is a
+ * single relaxed atomic store and the renderer picks the value up on its
+ * next tick, so it is cheap enough to call from a tight loop.
+ *
+ * The value is stored but not shown while the progress source has a total,
+ * i.e. after setTotal() with a non-zero total or while a source with a total
+ * is set: the bar then follows the work counter.
+ *
+ * \param new_percentage New percentage value between 0 and 100. Values outside
+ *                       that range are clamped.
+ */
+void WorkProgressIndicator::updateProgress(double new_percentage) {
+    pending_percentage.store(new_percentage, std::memory_order_relaxed);
+    counters.countUpdate();
+    if (deferred()) {
+        return;
+    }
+
+    TimedLock lock(mutex, counters);
+    applyProgress();
+}
+
+/**
+ * \brief Updates the label and redraws the bar, either immediately or on
+ * the next renderer tick.
+ *
+ * \param new_text The new label string.
+ */
+void WorkProgressIndicator::updateText(const std::string& new_text) {
+    counters.countUpdate();
+    TimedLock lock(mutex, counters);
+    setLabel(new_text);
+    dirty = true;
+    if (deferred()) {
+        return;
+    }
+    redraw();
+}
+
+/**
+ * \brief Sets the number of work units that make up 100%.
+ *
+ * Once a total is set, the bar follows the work counter instead of
+ * updateProgress() and shows the throughput and the estimated time left.
+ * In immediate mode, the renderer then draws the bar at 30 Hz until the
+ * total is set back to 0, so that advance() and setDone() never draw.
+ * Call this from the thread that controls the bar, like start().
+ *
+ * \param total Total number of work units; 0 switches back to percentages.
+ */
+void WorkProgressIndicator::setTotal(uint64_t total) {
+    work.setTotal(total);
+    counters.countUpdate();
+    bool counting = total > 0;
+    if (!counting) {
+        TimedLock lock(mutex, counters);
+        counting = external_source != nullptr;
+    }
+    followWork(counting);
+}
+
+/**
+ * \brief Marks count more work units as done.
+ *
+ * A single relaxed atomic operation in every mode, so any thread can call
+ * it from a tight loop; the bar, the rate and the ETA are updated by the
+ * renderer.
+ *
+ * \param count Number of units finished since the last call.
+ */
+void WorkProgressIndicator::advance(uint64_t count) {
+    work.advance(count);
+    counters.countUpdate();
+}
+
+/**
+ * \brief Sets the number of work units done.
+ *
+ * Like advance(), a single relaxed atomic store.
+ *
+ * \param done Number of units finished so far.
+ */
+void WorkProgressIndicator::setDone(uint64_t done) {
+    work.setDone(done);
+    counters.countUpdate();
+}
+
+/**
+ * \brief Makes the bar show the progress of another source.
+ *
+ * The source is only read when the bar renders, so it can be fed by many
+ * threads, e.g. a ShardedCounter. While a source is set, setTotal(),
+ * advance() and setDone() have no visible effect, and a bar in immediate
+ * mode is drawn by the renderer at 30 Hz, as while counting work units.
+ * Call this from the thread that controls the bar.
+ *
+ * \param new_source The source to show, or nullptr for the bar's own counter.
+ */
+void WorkProgressIndicator::setSource(std::shared_ptr<const ProgressSource> new_source) {
+    counters.countUpdate();
+    bool counting = false;
+    {
+        TimedLock lock(mutex, counters);
+        external_source = std::move(new_source);
+        source = external_source ? external_source.get() : &work;
+        source_label_generation = 0;
+        throughput.reset();
+        dirty = true;
+        counting = external_source != nullptr || work.total() > 0;
+        if (!deferred()) {
+            drawChanges();
+        }
+    }
+    followWork(counting);
+}
+
+/**
+ * \brief Reads the progress source for the frame about to be drawn.
+ *
+ * A source such as a TaskNode walks its whole tree to answer, so the bar
+ * reads it once here and the rest of the frame uses source_progress.
+ *
+ * \note The caller must hold the mutex.
+ */
+void WorkProgressIndicator::readSource() {
+    source_progress = source->aggregate();
+}
+
+/**
+ * \brief Returns the latest progress reported by the producer.
+ *
+ * Derived from the progress source, as of the last readSource(), when it
+ * has a total, otherwise the last value passed to updateProgress().
+ *
+ * \note The caller must hold the mutex.
+ */
+double WorkProgressIndicator::pendingPercentage() const {
+    if (source_progress.total > 0) {
+        return 100.0 * source_progress.fraction;
+    }
+    return pending_percentage.load(std::memory_order_relaxed);
+}
+
+/**
+ * \brief Clears the percentage, the done count and the throughput for a new
+ * run of the bar.
+ *
+ * \note The caller must hold the mutex.
+ */
+void WorkProgressIndicator::resetWork() {
+    pending_percentage.store(0.0, std::memory_order_relaxed);
+    work.setDone(0);
+    throughput.reset();
+    stats_reserve = 0;
+    readSource();
+}
+
+/**
+ * \brief Starts the renderer in deferred mode, and in immediate mode while
+ * the bar counts work units.
+ *
+ * Called without the mutex held. Managed bars are drawn by their
+ * MultiProgress instead.
+ */
+void WorkProgressIndicator::startRendering() {
+    if (refresh_rate_hz > 0) {
+        startRenderer(std::chrono::microseconds(1000000 / refresh_rate_hz));
+    } else if (following_work.load(std::memory_order_relaxed)) {
+        startRenderer(work_interval);
+    }
+}
+
+/**
+ * \brief Feeds the done count of a source with a total to the throughput
+ * estimate.
+ *
+ * \return true if the rate changed.
+ * \note The caller must hold the mutex.
+ */
+bool WorkProgressIndicator::sampleThroughput() {
+    return source_progress.total > 0 &&
+           throughput.sample(source_progress.done, ThroughputEstimator::Clock::now());
+}
+
+/**
+ * \brief Formats the throughput and ETA into stats_text while counting work
+ * units, and leaves it empty otherwise.
+ *
+ * stats_reserve only grows, so the bar does not jump back and forth as the
+ * stats change length.
+ *
+ * \note The caller must hold the mutex.
+ */
+void WorkProgressIndicator::composeStats() {
+    stats_text.clear();
+    if (source_progress.total > 0) {
+        throughput.appendStats(stats_text, source_progress.done, source_progress.total);
+    }
+    stats_reserve = std::max(stats_reserve, stats_text.size());
+}
+
+/**
+ * \brief Adds the counts and the throughput to the snapshot.
+ *
+ * Reads the source afresh, so a snapshot taken after the last frame still
+ * has the final counts.
+ *
+ * \note The caller must hold the mutex.
+ */
+void WorkProgressIndicator::fillSnapshot(ProgressSnapshot& snapshot) {
+    ProgressIndicator::fillSnapshot(snapshot);
+    readSource();
+    snapshot.done = source_progress.done;
+    snapshot.total = source_progress.total;
+    snapshot.percentage = pendingPercentage();
+    snapshot.rate = throughput.rate();
+    snapshot.eta_seconds = throughput.etaSeconds(snapshot.done, snapshot.total);
+}
+
+/**
+ * \brief Hands the drawing of an immediate-mode bar to the renderer when it
+ * starts counting work units, and takes it back when it stops.
+ *
+ * Producers then only touch the counter, and the throughput is sampled on
+ * the renderer thread alone. Called without the mutex held; bars with a
+ * refresh rate or in a MultiProgress always have a renderer.
+ *
+ * \param follow Whether the bar counts work units.
+ */
+void WorkProgressIndicator::followWork(bool follow) {
+    if (refresh_rate_hz > 0 || managed || following_work.exchange(follow, std::memory_order_relaxed) == follow) {
+        return;
+    }
+    if (follow) {
+        startRenderer(work_interval);
+        return;
+    }
+    stopRenderer();
+    TimedLock lock(mutex, counters);
+    drawChanges();
+}
+
+/**
+ * \brief Draws the bar from the calling thread if its visible content
+ * changed.
+ *
+ * \note The caller must hold the mutex.
+ */
+void WorkProgressIndicator::drawChanges() {
+    if (!refresh()) {
+        return;
+    }
+    IConsole::FrameScope scope;
+    frame_buffer.clear();
+    composeRefreshed(frame_buffer);
+    writeFrame(frame_buffer);
+}
@@ -0,0 +1,98 @@
+#include "check.hpp"
+#include "progress_spinner/output_sink.hpp"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Checks that AsyncSink drops frames instead of blocking while its target is
+// stuck, and that it writes every queued frame on flush and when destroyed.
+
+/**
+ * \brief Sink that holds every write until it is opened, like a terminal
+ * that stopped reading.
+ */
+class GateSink : public OutputSink {
+public:
+    explicit GateSink(std::shared_ptr<MemorySink> target) : target(std::move(target)), entered(false), open(false) {}
+
+    bool write(const char* data, size_t size) override {
+        std::unique_lock<std::mutex> lock(mutex);
+        entered = true;
+        changed.notify_all();
+        changed.wait(lock, [this]() { return open; });
+        return target->write(data, size);
+    }
+
+    void waitEntered() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return entered; });
+    }
+
+    void openGate() {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        changed.notify_all();
+    }
+
+private:
+    std::shared_ptr<MemorySink> target;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool entered;
+    bool open;
+};
+
+static bool writeText(OutputSink& sink, const std::string& text) {
+    return sink.write(text.data(), text.size());
+}
+
+static void testDropWhenFull() {
+    auto memory = std::make_shared<MemorySink>();
+    auto gate = std::make_shared<GateSink>(memory);
+    AsyncSink sink(gate, 2);
+
+    // The writer takes f1 and blocks in the target; f2 and f3 fill the ring
+    CHECK(writeText(sink, "f1"));
+    gate->waitEntered();
+    CHECK(writeText(sink, "f2"));
+    CHECK(writeText(sink, "f3"));
+    CHECK_EQ(sink.pendingBytes(), size_t(6));
+
+    CHECK(!writeText(sink, "f4"));
+    CHECK(!writeText(sink, "f5"));
+    CHECK_EQ(sink.droppedFrames(), uint64_t(2));
+    CHECK_EQ(memory->contents(), "");
+
+    gate->openGate();
+    sink.flush();
+    CHECK_EQ(memory->contents(), "f1f2f3");
+    CHECK_EQ(sink.pendingBytes(), size_t(0));
+
+    // With room in the ring again, frames are accepted
+    CHECK(writeText(sink, "f6"));
+    sink.flush();
+    CHECK_EQ(memory->contents(), "f1f2f3f6");
+    CHECK_EQ(sink.droppedFrames(), uint64_t(2));
+}
+
+static void testWriteQueuedOnStop() {
+    auto memory = std::make_shared<MemorySink>();
+    auto gate = std::make_shared<GateSink>(memory);
+    {
+        AsyncSink sink(gate, 4);
+        CHECK(writeText(sink, "a"));
+        gate->waitEntered();
+        CHECK(writeText(sink, "b"));
+        CHECK(writeText(sink, "c"));
+        CHECK_EQ(memory->contents(), "");
+        gate->openGate();
+    }
+    CHECK_EQ(memory->contents(), "abc");
+}
+
+int main() {
+    testDropWhenFull();
+    testWriteQueuedOnStop();
+    return checkResult();
+}
@@ -0,0 +1,90 @@
+#ifndef PROGRESS_INDICATOR_TEST_CHECK_HPP
+#define PROGRESS_INDICATOR_TEST_CHECK_HPP
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+// Minimal checks for the tests run by ctest. A failed check prints where it
+// failed and what it saw, and the test keeps going; checkResult() turns
+// the failures into the exit status.
+
+namespace check_detail {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/**
+ * \brief Makes control characters in text visible, e.g. "\033" as "\e".
+ */
+inline std::string visible(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        switch (c) {
+        case '\033':
+            out += "\\e";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out;
+}
+
+template <typename T>
+std::string describe(const T& value) {
+    std::ostringstream out;
+    out << value;
+    return out.str();
+}
+
+inline std::string describe(const std::string& value) {
+    return "\"" + visible(value) + "\"";
+}
+
+inline std::string describe(const char* value) {
+    return describe(std::string(value));
+}
+
+template <typename A, typename E>
+void checkEqual(const A& actual, const E& expected, const char* actual_text, const char* file, int line) {
+    if (actual == expected) {
+        return;
+    }
+    ++failures();
+    std::printf("%s:%d: CHECK_EQ(%s) failed\n  actual:   %s\n  expected: %s\n", file, line, actual_text,
+                describe(actual).c_str(), describe(expected).c_str());
+}
+
+} // namespace check_detail
+
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            ++check_detail::failures();                                          \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+        }                                                                        \
+    } while (false)
+
+#define CHECK_EQ(actual, expected) check_detail::checkEqual((actual), (expected), #actual, __FILE__, __LINE__)
+
+/**
+ * \brief Returns the exit status of a test: 0 if every check passed.
+ */
+inline int checkResult() {
+    if (check_detail::failures() > 0) {
+        std::printf("%d check(s) failed\n", check_detail::failures());
+        return 1;
+    }
+    return 0;
+}
+
+#endif // PROGRESS_INDICATOR_TEST_CHECK_HPP
@@ -0,0 +1,195 @@
+#include "check.hpp"
+#include "progress_spinner/progress_indicators.hpp"
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Checks that frame traces read back as recorded: against the golden trace
+// in test/golden, after recording its frames again, and for the rows of a
+// MultiProgress.
+
+struct ExpectedSpan {
+    uint64_t source_id;
+    std::string bytes;
+};
+
+// The frames of golden/frames.trace; golden/frames.out is their bytes
+static const std::vector<std::vector<ExpectedSpan>> golden_frames = {
+    {{0, "\033[?25l"}},
+    {{1, "\r\033[KA: [####------]"}, {2, "\n\r\033[KB: [#######---]"}},
+    {{0, "\r\033[1A\033[Ja log line\n"}, {1, "\r\033[KA: [####------]"}, {2, "\n\r\033[KB: [#########-]"}},
+    {{1, "\033[1A\rA: ok\033[K"}, {2, "\033[1B\rB: ok\033[K"}, {0, "\n"}},
+    {{0, "\033[?25h"}},
+};
+
+static std::string readFile(const std::string& path) {
+    std::string text;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return text;
+    }
+    char chunk[4096];
+    size_t size;
+    while ((size = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, size);
+    }
+    std::fclose(file);
+    return text;
+}
+
+static std::string tempPath() {
+    char path[] = "/tmp/frame_trace_test.XXXXXX";
+    int fd = mkstemp(path);
+    if (fd >= 0) {
+        close(fd);
+    }
+    return path;
+}
+
+/**
+ * \brief Checks that the frames of reader are the golden frames.
+ */
+static void checkGoldenFrames(TraceReader& reader) {
+    CHECK(reader.isTerminal());
+    CHECK_EQ(reader.columns(), size_t(40));
+
+    TraceFrame frame;
+    uint64_t previous_ns = 0;
+    for (const std::vector<ExpectedSpan>& expected : golden_frames) {
+        CHECK(reader.next(frame));
+        CHECK(frame.time_ns >= previous_ns);
+        previous_ns = frame.time_ns;
+        CHECK_EQ(frame.spans.size(), expected.size());
+        size_t offset = 0;
+        for (size_t i = 0; i < frame.spans.size() && i < expected.size(); ++i) {
+            CHECK_EQ(frame.spans[i].source_id, expected[i].source_id);
+            CHECK_EQ(frame.bytes.substr(offset, frame.spans[i].size), expected[i].bytes);
+            offset += frame.spans[i].size;
+        }
+        CHECK_EQ(offset, frame.bytes.size());
+    }
+    CHECK(!reader.next(frame));
+}
+
+static void testReadGolden(const std::string& golden_dir) {
+    TraceReader reader(golden_dir + "/frames.trace");
+    checkGoldenFrames(reader);
+
+    // Times add up the deltas, 1 us and three frames of 33.3 ms
+    TraceReader timed(golden_dir + "/frames.trace");
+    TraceFrame frame;
+    uint64_t last_ns = 0;
+    while (timed.next(frame)) {
+        last_ns = frame.time_ns;
+    }
+    CHECK_EQ(last_ns, uint64_t(2000 + 3 * 33333333));
+}
+
+static void testRecordAndReplay(const std::string& golden_dir) {
+    std::string path = tempPath();
+    auto memory = std::make_shared<MemorySink>(true, 40);
+    {
+        RecordingSink recorder(memory, path);
+        for (const std::vector<ExpectedSpan>& expected : golden_frames) {
+            std::string bytes;
+            std::vector<FrameSpan> spans;
+            for (const ExpectedSpan& span : expected) {
+                bytes += span.bytes;
+                spans.push_back(FrameSpan{span.source_id, span.bytes.size()});
+            }
+            CHECK(recorder.writeFrame(bytes.data(), bytes.size(), spans.data(), spans.size()));
+        }
+        recorder.flush();
+        CHECK_EQ(recorder.recordedFrames(), uint64_t(golden_frames.size()));
+    }
+    CHECK_EQ(memory->contents(), readFile(golden_dir + "/frames.out"));
+
+    TraceReader reader(path);
+    checkGoldenFrames(reader);
+
+    // Replaying the bytes gives what the terminal received
+    TraceReader replay(path);
+    MemorySink replayed(replay.isTerminal(), replay.columns());
+    TraceFrame frame;
+    while (replay.next(frame)) {
+        replayed.write(frame.bytes.data(), frame.bytes.size());
+    }
+    CHECK_EQ(replayed.contents(), memory->contents());
+    unlink(path.c_str());
+}
+
+/**
+ * \brief Returns the bytes of the span of source_id in frame, or "" without one.
+ */
+static std::string spanOf(const TraceFrame& frame, uint64_t source_id) {
+    size_t offset = 0;
+    for (const FrameSpan& span : frame.spans) {
+        if (span.source_id == source_id) {
+            return frame.bytes.substr(offset, span.size);
+        }
+        offset += span.size;
+    }
+    return std::string();
+}
+
+static void testMultiProgressSpans() {
+    std::string path = tempPath();
+    auto memory = std::make_shared<MemorySink>(true, 40);
+    IConsole::setSink(std::make_shared<RecordingSink>(memory, path));
+    uint64_t a_id = 0;
+    uint64_t b_id = 0;
+    {
+        MultiProgress multi;
+        HProgressBar& a = multi.add<HProgressBar>(HProgressBarOptions(
+            option::Label{"A: "},
+            option::CompletedLabel{"ok"},
+            option::NumOfSegments{10},
+            option::ProgressChars{"-", "#"},
+            option::BracketChars{"[", "]"}
+        ));
+        HProgressBar& b = multi.add<HProgressBar>(HProgressBarOptions(
+            option::Label{"B: "},
+            option::CompletedLabel{"ok"},
+            option::NumOfSegments{10},
+            option::ProgressChars{"-", "#"},
+            option::BracketChars{"[", "]"}
+        ));
+        a_id = a.id();
+        b_id = b.id();
+        multi.start();
+        a.start();
+        b.start();
+        a.updateProgress(40);
+        b.updateProgress(70);
+        a.stop();
+        b.stop();
+        multi.stop();
+    }
+    IConsole::setSink(memory);
+    CHECK(a_id != b_id);
+
+    // The last frame with rows of both bars draws them done
+    TraceReader reader(path);
+    TraceFrame frame;
+    TraceFrame last_rows;
+    while (reader.next(frame)) {
+        if (!spanOf(frame, a_id).empty() && !spanOf(frame, b_id).empty()) {
+            last_rows = frame;
+        }
+    }
+    CHECK(spanOf(last_rows, a_id).find("A: ok") != std::string::npos);
+    CHECK(spanOf(last_rows, b_id).find("B: ok") != std::string::npos);
+    CHECK(spanOf(last_rows, a_id).find("B: ") == std::string::npos);
+    CHECK(spanOf(last_rows, b_id).find("A: ") == std::string::npos);
+    unlink(path.c_str());
+}
+
+int main(int argc, char** argv) {
+    std::string golden_dir = argc > 1 ? argv[1] : "test/golden";
+    testReadGolden(golden_dir);
+    testRecordAndReplay(golden_dir);
+    testMultiProgressSpans();
+    return checkResult();
+}
@@ -0,0 +1,77 @@
+#include "check.hpp"
+#include "progress_spinner/log_line.hpp"
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Checks when LogLine prints a line: first line, percent steps, interval and
+// final line.
+
+static void testPercentSteps() {
+    LogLine log_line(0, 10);
+    std::string frame;
+
+    log_line.update("Copy 1%", 1, frame);
+    CHECK_EQ(frame, "Copy 1%\n");
+
+    // Same step: nothing, however often the line changes
+    log_line.update("Copy 5%", 5, frame);
+    log_line.update("Copy 9%", 9.9, frame);
+    CHECK_EQ(frame, "Copy 1%\n");
+
+    // Next step: logged once
+    log_line.update("Copy 10%", 10, frame);
+    log_line.update("Copy 10%", 10, frame);
+    log_line.update("Copy 14%", 14, frame);
+    CHECK_EQ(frame, "Copy 1%\nCopy 10%\n");
+
+    // Skipping steps logs one line
+    log_line.update("Copy 47%", 47, frame);
+    CHECK_EQ(frame, "Copy 1%\nCopy 10%\nCopy 47%\n");
+
+    // An identical line is never repeated, even in a new step
+    log_line.update("Copy 47%", 55, frame);
+    CHECK_EQ(frame, "Copy 1%\nCopy 10%\nCopy 47%\n");
+
+    frame.clear();
+    log_line.finish("Copy done", frame);
+    CHECK_EQ(frame, "Copy done\n");
+}
+
+static void testFinishAfterLastLine() {
+    LogLine log_line(0, 10);
+    std::string frame;
+    log_line.update("Copy 100%", 100, frame);
+    log_line.finish("Copy 100%", frame);
+    CHECK_EQ(frame, "Copy 100%\n");
+
+    // The next update starts a new log
+    log_line.update("Copy 100%", 100, frame);
+    CHECK_EQ(frame, "Copy 100%\nCopy 100%\n");
+}
+
+static void testInterval() {
+    LogLine log_line(1, 0);
+    std::string frame;
+
+    log_line.update("Scan 1 file", -1, frame);
+    log_line.update("Scan 2 files", -1, frame);
+    log_line.update("Scan 3 files", -1, frame);
+    CHECK_EQ(frame, "Scan 1 file\n");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1050));
+    log_line.update("Scan 4 files", -1, frame);
+    log_line.update("Scan 5 files", -1, frame);
+    CHECK_EQ(frame, "Scan 1 file\nScan 4 files\n");
+
+    frame.clear();
+    log_line.finish("Scan 5 files", frame);
+    CHECK_EQ(frame, "Scan 5 files\n");
+}
+
+int main() {
+    testPercentSteps();
+    testFinishAfterLastLine();
+    testInterval();
+    return checkResult();
+}
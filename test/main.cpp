@@ -2,6 +2,7 @@
 #include <iostream>
 #include <thread>  // Required for std::this_thread::sleep_for
 #include <chrono>  // Required for std::chrono::milliseconds
+#include <vector>
 
 int main() {
     std::cout << "HProgressBar Demo:\n";
@@ -25,6 +26,57 @@ int main() {
     }
     hp_bar.stop();
 
+    // Deferred rendering: updates are atomic stores, a renderer draws at 30 Hz
+    HProgressBarOptions fast_options(
+        option::Label{"Crunching: "},
+        option::CompletedLabel{"✓ OK!"},
+        option::NumOfSegments{30},
+        option::ProgressChars{"-", "#"},
+        option::BracketChars{"[", "]"},
+        option::RefreshRateHz{30}
+    );
+
+    HProgressBar fast_bar(fast_options);
+
+    fast_bar.start();
+    const int fast_steps = 20000000;
+    for (int i = 0; i <= fast_steps; ++i) {
+        fast_bar.updateProgress(100.0 * i / fast_steps);
+    }
+    fast_bar.stop();
+
+    // Work units counted by iterating through track(): the bar shows throughput and ETA
+    HProgressBar items_bar(HProgressBarOptions(
+        option::Label{"Items: "},
+        option::CompletedLabel{"✓ OK!"},
+        option::NumOfSegments{30},
+        option::ProgressChars{"-", "#"},
+        option::BracketChars{"[", "]"},
+        option::RefreshRateHz{30}
+    ));
+
+    std::vector<int> items(2000);
+    items_bar.start();
+    for (int& item : track(items, items_bar)) {
+        item = 1;
+        std::this_thread::sleep_for(std::chrono::microseconds(1500));
+    }
+    items_bar.stop();
+
+    // Width and glyphs fixed at compile time
+    BasicHProgressBar<20, bar_style::SmoothBlocks> smooth_bar(BasicHProgressBarOptions(
+        option::Label{"Copying: "},
+        option::CompletedLabel{"✓ OK!"},
+        option::RefreshRateHz{30}
+    ));
+
+    smooth_bar.start();
+    for (int i = 0; i <= 100; ++i) {
+        smooth_bar.updateProgress(i);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    smooth_bar.stop();
+
     std::cout << "\nVProgressBar Demo:\n";
 
     // Construct a VProgressBar with default options
@@ -121,5 +173,40 @@ int main() {
     }
     custom_spinner3.stop();
 
+    std::cout << "\nMultiProgress Demo:\n";
+
+    // Several indicators drawn together as one block
+    MultiProgress multi;
+
+    HProgressBar& download = multi.add<HProgressBar>(HProgressBarOptions(
+        option::Label{"Download: "},
+        option::CompletedLabel{"✓ OK!"},
+        option::NumOfSegments{30},
+        option::ProgressChars{"-", "#"},
+        option::BracketChars{"[", "]"}
+    ));
+    HProgressBar& compact = multi.add<HProgressBar>(HProgressBarOptions(
+        option::Label{"Compact:  "},
+        option::CompletedLabel{"✓ OK!"},
+        option::NumOfSegments{30},
+        option::ProgressChars{"-", "#"},
+        option::BracketChars{"[", "]"}
+    ));
+    ProgressSpinner& waiting = multi.add<ProgressSpinner>(ProgressSpinnerOptions(option::Label{"Waiting:  "}));
+
+    multi.start();
+    download.start();
+    compact.start();
+    waiting.start();
+    for (int i = 0; i <= 100; ++i) {
+        download.updateProgress(i);
+        compact.updateProgress(i / 2.0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    }
+    download.stop();
+    compact.stop();
+    waiting.stop();
+    multi.stop();
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "check.hpp"
+#include "progress_spinner/progress_indicators.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+// Checks the fields of the JSON lines a ProgressExporter writes for a bar.
+
+static std::string readFile(const std::string& path) {
+    std::string text;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return text;
+    }
+    char chunk[4096];
+    size_t size;
+    while ((size = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, size);
+    }
+    std::fclose(file);
+    return text;
+}
+
+/**
+ * \brief Returns the last exported line of the indicator with the given id.
+ */
+static std::string lastLineOf(const std::string& exported, uint64_t id) {
+    std::string key = ",\"id\":" + std::to_string(id) + ",";
+    std::string found;
+    size_t start = 0;
+    while (start < exported.size()) {
+        size_t end = exported.find('\n', start);
+        if (end == std::string::npos) {
+            end = exported.size();
+        }
+        std::string line = exported.substr(start, end - start);
+        if (line.find(key) != std::string::npos) {
+            found = line;
+        }
+        start = end + 1;
+    }
+    return found;
+}
+
+/**
+ * \brief Returns the text between "field": and the next comma or brace.
+ */
+static std::string field(const std::string& line, const std::string& name) {
+    std::string key = "\"" + name + "\":";
+    size_t start = line.find(key);
+    if (start == std::string::npos) {
+        return "<missing>";
+    }
+    start += key.size();
+    size_t end = start;
+    if (line[start] == '"') {
+        for (end = start + 1; end < line.size() && line[end] != '"'; ++end) {
+            if (line[end] == '\\') {
+                ++end;
+            }
+        }
+        return line.substr(start, end + 1 - start);
+    }
+    end = line.find_first_of(",}", start);
+    return line.substr(start, end - start);
+}
+
+static void exportOnce(int fd) {
+    ProgressExporter exporter(ExportTarget::fileDescriptor(fd), ProgressExporterOptions(option::ExportIntervalMs{10000}));
+    exporter.start();
+    exporter.stop();
+    CHECK(exporter.snapshotsWritten() >= 1);
+    CHECK_EQ(exporter.snapshotsDropped(), uint64_t(0));
+}
+
+int main() {
+    IConsole::setSink(std::make_shared<MemorySink>(true, 80));
+
+    char path[] = "/tmp/progress_exporter_test.XXXXXX";
+    int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0) {
+        return checkResult();
+    }
+
+    HProgressBar bar(HProgressBarOptions(
+        option::Label{"Say \"hi\" \\ "},
+        option::CompletedLabel{"done"},
+        option::NumOfSegments{10},
+        option::ProgressChars{"-", "#"},
+        option::BracketChars{"[", "]"}
+    ));
+    bar.start();
+    bar.setTotal(200);
+    bar.advance(50);
+
+    exportOnce(fd);
+    std::string line = lastLineOf(readFile(path), bar.id());
+    CHECK_EQ(line.substr(0, 8), "{\"time\":");
+    CHECK_EQ(line.substr(line.size() - 1), "}");
+    CHECK_EQ(field(line, "snapshot"), "1");
+    CHECK_EQ(field(line, "label"), "\"Say \\\"hi\\\" \\\\ \"");
+    CHECK_EQ(field(line, "state"), "\"running\"");
+    CHECK_EQ(field(line, "done"), "50");
+    CHECK_EQ(field(line, "total"), "200");
+    CHECK_EQ(field(line, "percent"), "25.0");
+    CHECK(field(line, "rate") != "<missing>");
+    CHECK(field(line, "eta") != "<missing>");
+
+    // A stopped bar keeps being exported with its final state
+    bar.stop();
+    exportOnce(fd);
+    line = lastLineOf(readFile(path), bar.id());
+    CHECK_EQ(field(line, "state"), "\"done\"");
+    CHECK_EQ(field(line, "percent"), "100.0");
+    CHECK_EQ(field(line, "done"), "50");
+    CHECK_EQ(field(line, "total"), "200");
+
+    close(fd);
+    unlink(path);
+    return checkResult();
+}
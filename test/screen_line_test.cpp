@@ -0,0 +1,77 @@
+#include "check.hpp"
+#include "progress_spinner/screen_line.hpp"
+#include <string>
+
+// Checks the exact bytes ScreenLine emits for a line and for cursor moves.
+
+static std::string draw(ScreenLine& screen_line, const std::string& line) {
+    std::string frame;
+    screen_line.update(line, frame);
+    return frame;
+}
+
+static void testDiffs() {
+    ScreenLine screen_line;
+    CHECK_EQ(draw(screen_line, "Load: [----]"), "\r\033[KLoad: [----]");
+    CHECK(screen_line.shows("Load: [----]"));
+    CHECK_EQ(draw(screen_line, "Load: [----]"), "");
+
+    // Only the changed cell is written, after moving over the prefix
+    CHECK_EQ(draw(screen_line, "Load: [#---]"), "\r\033[7C#");
+    CHECK_EQ(draw(screen_line, "Load: [##--]"), "\r\033[8C#");
+
+    // A shorter line clears the rest of the old one
+    CHECK_EQ(draw(screen_line, "Load: done"), "\r\033[6Cdone\033[K");
+
+    // After invalidate() the whole line is drawn again
+    screen_line.invalidate();
+    CHECK(!screen_line.shows("Load: done"));
+    CHECK_EQ(draw(screen_line, "Load: done"), "\r\033[KLoad: done");
+}
+
+static void testShortPrefix() {
+    // A prefix no longer than the cursor move is rewritten instead
+    ScreenLine screen_line;
+    draw(screen_line, "abcdef");
+    CHECK_EQ(draw(screen_line, "abXdef"), "\rabX");
+}
+
+static void testUtf8() {
+    // Columns count cells, not bytes; "░" and "█" take three bytes each
+    ScreenLine screen_line;
+    draw(screen_line, "Progress: ░░");
+    CHECK_EQ(draw(screen_line, "Progress: █░"), "\r\033[10C█");
+    CHECK_EQ(draw(screen_line, "Progress: ██"), "\r\033[11C█");
+}
+
+static void testCursorMoves() {
+    std::string frame;
+    ScreenLine::appendCursorMove(frame, 12, 'C');
+    CHECK_EQ(frame, "\033[12C");
+
+    frame.clear();
+    size_t cursor_row = 2;
+    ScreenLine::moveToRow(frame, 3, cursor_row, 0);
+    CHECK_EQ(frame, "\033[2A");
+    CHECK_EQ(cursor_row, size_t(0));
+
+    // Rows past the drawn ones are added with newlines
+    frame.clear();
+    ScreenLine::moveToRow(frame, 3, cursor_row, 4);
+    CHECK_EQ(frame, "\033[2B\n\n");
+    CHECK_EQ(cursor_row, size_t(4));
+
+    frame.clear();
+    cursor_row = 2;
+    ScreenLine::moveToRow(frame, 3, cursor_row, 3);
+    CHECK_EQ(frame, "\n");
+    CHECK_EQ(cursor_row, size_t(3));
+}
+
+int main() {
+    testDiffs();
+    testShortPrefix();
+    testUtf8();
+    testCursorMoves();
+    return checkResult();
+}
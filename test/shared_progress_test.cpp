@@ -0,0 +1,78 @@
+#include "check.hpp"
+#include "progress_spinner/shared_progress.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <system_error>
+#include <unistd.h>
+
+// Checks that a second process sees and updates the slots of a named
+// SharedProgress segment.
+
+/**
+ * \brief Body of the child process; returns its exit status, 0 if the
+ * segment looked as the parent left it.
+ */
+static int runChild(const std::string& name) {
+    try {
+        std::unique_ptr<SharedProgress> progress = SharedProgress::attach(name);
+        if (progress->slotCount() != 2 || progress->slot(0).done() != 5 || progress->slot(0).total() != 10) {
+            return 2;
+        }
+        SharedProgress::Slot& slot = progress->slot(1);
+        slot.setTotal(40);
+        slot.setDone(30);
+        slot.setLabel("child");
+        progress->slot(0).advance(5);
+        return 0;
+    } catch (const std::exception&) {
+        return 3;
+    }
+}
+
+int main() {
+    std::string name = "/pi-test-" + std::to_string(getpid());
+    {
+        SharedProgress progress(2, name);
+        CHECK_EQ(progress.slotCount(), size_t(2));
+        progress.slot(0).setTotal(10);
+        progress.slot(0).setDone(5);
+
+        pid_t child = fork();
+        if (child == 0) {
+            _exit(runChild(name));
+        }
+        CHECK(child > 0);
+        int status = 0;
+        CHECK_EQ(waitpid(child, &status, 0), child);
+        CHECK(WIFEXITED(status));
+        CHECK_EQ(WEXITSTATUS(status), 0);
+
+        // The child's updates are visible here
+        CHECK_EQ(progress.slot(0).done(), uint64_t(10));
+        CHECK_EQ(progress.slot(1).done(), uint64_t(30));
+        CHECK_EQ(progress.slot(1).total(), uint64_t(40));
+        CHECK_EQ(progress.done(), uint64_t(40));
+        CHECK_EQ(progress.total(), uint64_t(50));
+
+        std::shared_ptr<const ProgressSource> source = progress.source(1);
+        uint64_t generation = 0;
+        std::string label;
+        CHECK(source->label(generation, label));
+        CHECK_EQ(label, "child");
+        CHECK(!source->label(generation, label));
+        CHECK_EQ(source->done(), uint64_t(30));
+        CHECK_EQ(source->total(), uint64_t(40));
+    }
+
+    // The creator removes the name when it is destroyed
+    bool removed = false;
+    try {
+        SharedProgress::attach(name);
+    } catch (const std::system_error&) {
+        removed = true;
+    }
+    CHECK(removed);
+    return checkResult();
+}
@@ -0,0 +1,211 @@
+#include "check.hpp"
+#include "progress_spinner/task_table.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Checks that a TaskTable shows the most active running tasks, by playing
+// its output on a small terminal model and reading the screen.
+
+/**
+ * \brief Just enough of a terminal for the sequences the indicators emit:
+ * CR, LF, ESC[K, ESC[J, cursor moves and cursor visibility.
+ */
+class Screen {
+public:
+    void play(const std::string& bytes) {
+        size_t i = 0;
+        while (i < bytes.size()) {
+            char c = bytes[i];
+            if (c == '\r') {
+                column = 0;
+                ++i;
+            } else if (c == '\n') {
+                ++row;
+                column = 0;
+                ++i;
+            } else if (c == '\033' && i + 1 < bytes.size() && bytes[i + 1] == '[') {
+                i = control(bytes, i + 2);
+            } else {
+                // One cell per code point; the tables only use narrow glyphs
+                size_t end = i + 1;
+                while (end < bytes.size() && (static_cast<unsigned char>(bytes[end]) & 0xC0) == 0x80) {
+                    ++end;
+                }
+                put(bytes.substr(i, end - i));
+                i = end;
+            }
+        }
+    }
+
+    std::vector<std::string> rows() const {
+        std::vector<std::string> text;
+        for (const std::vector<std::string>& cells : screen) {
+            std::string line;
+            for (const std::string& cell : cells) {
+                line += cell;
+            }
+            while (!line.empty() && line.back() == ' ') {
+                line.pop_back();
+            }
+            text.push_back(line);
+        }
+        while (!text.empty() && text.back().empty()) {
+            text.pop_back();
+        }
+        return text;
+    }
+
+private:
+    std::vector<std::vector<std::string>> screen;
+    size_t row = 0;
+    size_t column = 0;
+
+    std::vector<std::string>& line() {
+        if (screen.size() <= row) {
+            screen.resize(row + 1);
+        }
+        return screen[row];
+    }
+
+    void put(const std::string& cell) {
+        std::vector<std::string>& cells = line();
+        if (cells.size() <= column) {
+            cells.resize(column + 1, " ");
+        }
+        cells[column++] = cell;
+    }
+
+    size_t control(const std::string& bytes, size_t i) {
+        size_t count = 0;
+        bool has_count = false;
+        while (i < bytes.size() && (bytes[i] == '?' || (bytes[i] >= '0' && bytes[i] <= '9'))) {
+            if (bytes[i] != '?') {
+                count = count * 10 + static_cast<size_t>(bytes[i] - '0');
+                has_count = true;
+            }
+            ++i;
+        }
+        if (!has_count) {
+            count = 1;
+        }
+        char command = i < bytes.size() ? bytes[i] : '\0';
+        switch (command) {
+        case 'A':
+            row = count > row ? 0 : row - count;
+            break;
+        case 'B':
+            row += count;
+            break;
+        case 'C':
+            column += count;
+            break;
+        case 'D':
+            column = count > column ? 0 : column - count;
+            break;
+        case 'K':
+            if (line().size() > column) {
+                line().resize(column);
+            }
+            break;
+        case 'J':
+            if (line().size() > column) {
+                line().resize(column);
+            }
+            if (screen.size() > row + 1) {
+                screen.resize(row + 1);
+            }
+            break;
+        default:
+            // ESC[?25l and ESC[?25h: the cursor is not modelled
+            break;
+        }
+        return i + 1;
+    }
+};
+
+static size_t countRows(const std::vector<std::string>& rows, const std::string& text) {
+    size_t count = 0;
+    for (const std::string& row : rows) {
+        if (row.find(text) != std::string::npos) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+static void testMostActive() {
+    auto memory = std::make_shared<MemorySink>(true, 80);
+    IConsole::setSink(memory);
+
+    TaskTable table(16, TaskTableOptions(option::TopTasks{3}, option::TaskOrder{option::TaskOrder::MostActive},
+                                         option::RefreshRateHz{50}));
+    std::vector<TaskTable::TaskId> hot;
+    for (int i = 1; i <= 3; ++i) {
+        hot.push_back(table.addTask("hot-" + std::to_string(i), 1000000));
+    }
+    std::vector<TaskTable::TaskId> idle;
+    for (int i = 1; i <= 5; ++i) {
+        idle.push_back(table.addTask("idle-" + std::to_string(i), 1000000));
+    }
+    TaskTable::TaskId finished = table.addTask("finished", 100);
+    table.addTask("waiting", 100);
+
+    table.start();
+    for (TaskTable::TaskId task : idle) {
+        table.startTask(task);
+        table.advance(task, 10);
+    }
+    table.startTask(finished);
+    for (TaskTable::TaskId task : hot) {
+        table.startTask(task);
+    }
+
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(400);
+    while (std::chrono::steady_clock::now() < until) {
+        for (TaskTable::TaskId task : hot) {
+            table.advance(task, 100);
+        }
+        table.advance(finished, 1000);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    table.finishTask(finished);
+    until = std::chrono::steady_clock::now() + std::chrono::milliseconds(200);
+    while (std::chrono::steady_clock::now() < until) {
+        for (TaskTable::TaskId task : hot) {
+            table.advance(task, 100);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    table.stop();
+
+    CHECK_EQ(table.count(TaskTable::State::Running), size_t(8));
+    CHECK_EQ(table.count(TaskTable::State::Done), size_t(1));
+    CHECK_EQ(table.count(TaskTable::State::Queued), size_t(1));
+
+    Screen screen;
+    screen.play(memory->contents());
+    std::vector<std::string> rows = screen.rows();
+    CHECK_EQ(rows.size(), size_t(4));
+    if (!rows.empty()) {
+        CHECK_EQ(rows[0].substr(0, 36), "1/10 tasks done, 8 running, 1 queued");
+    }
+    CHECK_EQ(countRows(rows, "hot-1"), size_t(1));
+    CHECK_EQ(countRows(rows, "hot-2"), size_t(1));
+    CHECK_EQ(countRows(rows, "hot-3"), size_t(1));
+    CHECK_EQ(countRows(rows, "idle-"), size_t(0));
+    CHECK_EQ(countRows(rows, "finished"), size_t(0));
+    CHECK_EQ(countRows(rows, "waiting"), size_t(0));
+    if (rows.size() != 4) {
+        for (const std::string& row : rows) {
+            std::printf("  | %s\n", row.c_str());
+        }
+    }
+}
+
+int main() {
+    testMostActive();
+    return checkResult();
+}
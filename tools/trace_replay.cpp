@@ -0,0 +1,140 @@
+#include "progress_spinner/frame_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Replays a frame trace recorded with RecordingSink.
+//
+// Usage: trace_replay [--fast | --stats-only] trace.bin
+//
+// The frames are written to stdout at the speed they were recorded, or as
+// fast as possible with --fast; --stats-only writes nothing. Statistics on
+// frame sizes and the time between frames are printed to stderr at the end.
+
+namespace {
+
+/**
+ * \brief Writes a whole frame to standard output.
+ */
+void writeOut(const std::string& bytes) {
+    const char* data = bytes.data();
+    size_t size = bytes.size();
+    while (size > 0) {
+#ifdef _WIN32
+        int count = ::_write(1, data, static_cast<unsigned int>(size));
+#else
+        ssize_t count = ::write(1, data, size);
+#endif
+        if (count <= 0) {
+            return;
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+}
+
+/**
+ * \brief Returns the value below which the given fraction of the sorted
+ * samples lie.
+ */
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+/**
+ * \brief Prints min, mean, median, p99 and max of the samples.
+ */
+void printDistribution(const char* name, const char* unit, std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    double mean = samples.empty() ? 0.0 : sum / static_cast<double>(samples.size());
+    std::fprintf(stderr, "%-16s min %10.3f  mean %10.3f  p50 %10.3f  p99 %10.3f  max %10.3f %s\n", name,
+                 samples.empty() ? 0.0 : samples.front(), mean, percentile(samples, 0.5), percentile(samples, 0.99),
+                 samples.empty() ? 0.0 : samples.back(), unit);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool fast = false;
+    bool replay = true;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument == "--fast") {
+            fast = true;
+        } else if (argument == "--stats-only") {
+            replay = false;
+        } else {
+            path = argument;
+        }
+    }
+    if (path.empty()) {
+        std::fprintf(stderr, "usage: %s [--fast | --stats-only] trace.bin\n", argv[0]);
+        return 2;
+    }
+
+    try {
+        TraceReader reader(path);
+        TraceFrame frame;
+        std::vector<double> frame_sizes;
+        std::vector<double> frame_gaps_ms;
+        std::map<uint64_t, uint64_t> bytes_by_source;
+        uint64_t previous_ns = 0;
+        std::chrono::steady_clock::time_point replay_start = std::chrono::steady_clock::now();
+
+        while (reader.next(frame)) {
+            if (!frame_sizes.empty()) {
+                frame_gaps_ms.push_back(static_cast<double>(frame.time_ns - previous_ns) / 1e6);
+            }
+            previous_ns = frame.time_ns;
+            frame_sizes.push_back(static_cast<double>(frame.bytes.size()));
+            for (const FrameSpan& span : frame.spans) {
+                bytes_by_source[span.source_id] += span.size;
+            }
+            if (replay) {
+                if (!fast) {
+                    std::this_thread::sleep_until(replay_start + std::chrono::nanoseconds(frame.time_ns));
+                }
+                writeOut(frame.bytes);
+            }
+        }
+
+        double duration_s = static_cast<double>(previous_ns) / 1e9;
+        std::fprintf(stderr, "\ntrace            %s (%s, %zu columns)\n", path.c_str(),
+                     reader.isTerminal() ? "terminal" : "not a terminal", reader.columns());
+        std::fprintf(stderr, "frames           %zu in %.3f s\n", frame_sizes.size(), duration_s);
+        printDistribution("frame size", "bytes", frame_sizes);
+        printDistribution("between frames", "ms", frame_gaps_ms);
+        for (const auto& source : bytes_by_source) {
+            if (source.first == 0) {
+                std::fprintf(stderr, "source other     %llu bytes\n", static_cast<unsigned long long>(source.second));
+            } else {
+                std::fprintf(stderr, "source %-9llu %llu bytes\n", static_cast<unsigned long long>(source.first),
+                             static_cast<unsigned long long>(source.second));
+            }
+        }
+    } catch (const std::exception& error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    return 0;
+}